@@ -1,3 +1,5 @@
+#pragma once
+
 #include "simde/x86/avx2.h"
 #include <cstddef>
 
@@ -72,3 +74,88 @@ void simd_buffer_sub(float* buffer_a, float* buffer_b, size_t size)
         buffer_a[k] -= buffer_b[k];
     }
 }
+
+float simd_buffer_dot(const float* buffer_a, const float* buffer_b, size_t size)
+{
+    simde__m256 acc = simde_mm256_setzero_ps();
+    int i;
+    for (i = 0; i < size - size % 8; i += 8)
+    {
+        simde__m256 vec_a = simde_mm256_loadu_ps(&buffer_a[i]);
+        simde__m256 vec_b = simde_mm256_loadu_ps(&buffer_b[i]);
+        acc = simde_mm256_add_ps(acc, simde_mm256_mul_ps(vec_a, vec_b));
+    }
+    float lanes[8];
+    simde_mm256_storeu_ps(lanes, acc);
+    float sum = lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+    // non-vectorisable remaining elements
+    for (int k = i; k < size; k++)
+    {
+        sum += buffer_a[k] * buffer_b[k];
+    }
+    return sum;
+}
+
+double simd_buffer_dot(const double* buffer_a, const double* buffer_b, size_t size)
+{
+    simde__m256d acc = simde_mm256_setzero_pd();
+    int i;
+    for (i = 0; i < size - size % 4; i += 4)
+    {
+        simde__m256d vec_a = simde_mm256_loadu_pd(&buffer_a[i]);
+        simde__m256d vec_b = simde_mm256_loadu_pd(&buffer_b[i]);
+        acc = simde_mm256_add_pd(acc, simde_mm256_mul_pd(vec_a, vec_b));
+    }
+    double lanes[4];
+    simde_mm256_storeu_pd(lanes, acc);
+    double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    // non-vectorisable remaining elements
+    for (int k = i; k < size; k++)
+    {
+        sum += buffer_a[k] * buffer_b[k];
+    }
+    return sum;
+}
+
+// out_a = a * l + b * r and out_b = c * l + d * r, both outputs from one pass over the inputs
+void simd_buffer_matrix(const float* l, const float* r, float* out_a, float* out_b, size_t size, float a, float b, float c, float d)
+{
+    simde__m256 va = simde_mm256_set1_ps(a);
+    simde__m256 vb = simde_mm256_set1_ps(b);
+    simde__m256 vc = simde_mm256_set1_ps(c);
+    simde__m256 vd = simde_mm256_set1_ps(d);
+    int i;
+    for (i = 0; i < size - size % 8; i += 8)
+    {
+        simde__m256 vec_l = simde_mm256_loadu_ps(&l[i]);
+        simde__m256 vec_r = simde_mm256_loadu_ps(&r[i]);
+        simde_mm256_storeu_ps(&out_a[i], simde_mm256_add_ps(simde_mm256_mul_ps(va, vec_l), simde_mm256_mul_ps(vb, vec_r)));
+        simde_mm256_storeu_ps(&out_b[i], simde_mm256_add_ps(simde_mm256_mul_ps(vc, vec_l), simde_mm256_mul_ps(vd, vec_r)));
+    }
+    // non-vectorisable remaining elements
+    for (int k = i; k < size; k++)
+    {
+        float vl = l[k], vr = r[k];
+        out_a[k] = a * vl + b * vr;
+        out_b[k] = c * vl + d * vr;
+    }
+}
+
+// out = a * l + b * r
+void simd_buffer_mix(const float* l, const float* r, float* out, size_t size, float a, float b)
+{
+    simde__m256 va = simde_mm256_set1_ps(a);
+    simde__m256 vb = simde_mm256_set1_ps(b);
+    int i;
+    for (i = 0; i < size - size % 8; i += 8)
+    {
+        simde__m256 vec_l = simde_mm256_loadu_ps(&l[i]);
+        simde__m256 vec_r = simde_mm256_loadu_ps(&r[i]);
+        simde_mm256_storeu_ps(&out[i], simde_mm256_add_ps(simde_mm256_mul_ps(va, vec_l), simde_mm256_mul_ps(vb, vec_r)));
+    }
+    // non-vectorisable remaining elements
+    for (int k = i; k < size; k++)
+    {
+        out[k] = a * l[k] + b * r[k];
+    }
+}
@@ -16,18 +16,32 @@
 
 #include "Spectrogram.hpp"
 
+#include <chrono>
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------------------------------------------
 
 Spectrogram::Spectrogram()
-    : Plugin(3, 0, 0), // 3 parameters, 0 programs, 0 states
+    : Plugin(7, 0, 0), // 7 parameters, 0 programs, 0 states
       fColor(0.0f),
       fOutLeft(0.0f),
       fOutRight(0.0f),
+      fPitch(0.0f),
+      fClarity(0.0f),
+      fNote(0.0f),
+      fPitchMidi(0.0f),
+      fMidiNote(-1),
+      fNoteOffPending(false),
       fNeedsReset(true)
 {
     ring_buffer.createBuffer(sizeof(RbMsg) * 64); // 2 seconds of floats @ 48k + 2048 bytes
+    pitch_input.createBuffer(sizeof(float) * 65536); // over a second of mono samples @ 48k
+}
+
+Spectrogram::~Spectrogram()
+{
+    stopPitch();
 }
 
 const char* Spectrogram::getLabel() const
@@ -100,6 +114,29 @@ void Spectrogram::initParameter(uint32_t index, Parameter& parameter)
         parameter.name   = "out-right";
         parameter.symbol = "out_right";
         break;
+    case 3:
+        parameter.hints  = kParameterIsAutomatable|kParameterIsOutput;
+        parameter.name   = "pitch";
+        parameter.symbol = "pitch";
+        parameter.unit   = "Hz";
+        parameter.ranges.max = 2000.0f;
+        break;
+    case 4:
+        parameter.hints  = kParameterIsAutomatable|kParameterIsOutput;
+        parameter.name   = "clarity";
+        parameter.symbol = "clarity";
+        break;
+    case 5:
+        parameter.hints  = kParameterIsAutomatable|kParameterIsOutput|kParameterIsInteger;
+        parameter.name   = "note";
+        parameter.symbol = "note";
+        parameter.ranges.max = 127.0f;
+        break;
+    case 6:
+        parameter.hints  = kParameterIsAutomatable|kParameterIsBoolean;
+        parameter.name   = "pitch-midi";
+        parameter.symbol = "pitch_midi";
+        break;
     }
 }
 
@@ -110,6 +147,10 @@ float Spectrogram::getParameterValue(uint32_t index) const
         case 0: return fColor;
         case 1: return fOutLeft;
         case 2: return fOutRight;
+        case 3: return fPitch;
+        case 4: return fClarity;
+        case 5: return fNote;
+        case 6: return fPitchMidi;
     }
 
     return 0.0f;
@@ -117,9 +158,11 @@ float Spectrogram::getParameterValue(uint32_t index) const
 
 void Spectrogram::setParameterValue(uint32_t index, float value)
 {
-    if (index != 0) return;
-
-    fColor = value;
+    switch (index)
+    {
+        case 0: fColor = value; break;
+        case 6: fPitchMidi = value; break;
+    }
 }
 
 void Spectrogram::initState(uint32_t index, State& state)
@@ -148,21 +191,123 @@ void Spectrogram::sampleRateChanged (double	newSampleRate)
 void Spectrogram::deactivate()
 {
     d_stdout("deactivated :(");
+    stopPitch();
 }
 
 void Spectrogram::activate()
 {
     d_stdout("activated :) samplerate: %f buffersize: %d ", getSampleRate(), getBufferSize());
+    startPitch();
+}
+
+void Spectrogram::startPitch()
+{
+    stopPitch();
+    pitch.init(getSampleRate());
+    pitch_input.clearData();
+    pitch_frequency.store(0.0f);
+    pitch_clarity.store(0.0f);
+    pitch_quit.store(false);
+    pitch_thread = std::thread([this]() { pitchLoop(); });
+}
+
+void Spectrogram::stopPitch()
+{
+    if (fMidiNote >= 0) fNoteOffPending = true;
+    if (!pitch_thread.joinable()) return;
+    pitch_quit.store(true);
+    pitch_thread.join();
+}
+
+void Spectrogram::pitchLoop()
+{
+    float block[512];
+    while (!pitch_quit.load())
+    {
+        uint32_t available = pitch_input.getReadableDataSize() / sizeof(float);
+        if (available == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+        // behind by more than a window: only the newest one matters, start over from there
+        if (available > pitch.window_size) {
+            for (uint32_t skip = available - pitch.window_size; skip > 0; ) {
+                const uint32_t n = std::min<uint32_t>(skip, 512);
+                pitch_input.readCustomData(block, sizeof(float) * n);
+                skip -= n;
+            }
+            pitch.reset();
+            available = pitch.window_size;
+        }
+        const uint32_t n = std::min<uint32_t>(available, 512);
+        pitch_input.readCustomData(block, sizeof(float) * n);
+        if (pitch.feed(block, n) > 0) {
+            pitch_frequency.store(pitch.frequency, std::memory_order_relaxed);
+            pitch_clarity.store(pitch.clarity, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Spectrogram::sendNote(uint8_t status, int note, uint8_t velocity)
+{
+    MidiEvent event;
+    event.frame = 0;
+    event.size = 3;
+    event.data[0] = status;
+    event.data[1] = static_cast<uint8_t>(note);
+    event.data[2] = velocity;
+    writeMidiEvent(event);
 }
 
 void Spectrogram::run(const float** inputs, float** outputs, uint32_t frames)
 {
+    // the note held when the pitch thread last stopped
+    if (fNoteOffPending) {
+        if (fMidiNote >= 0) sendNote(0x80, fMidiNote, 0);
+        fMidiNote = -1;
+        fNoteOffPending = false;
+    }
+
+    // mono mix for the pitch thread, dropped while it can't keep up
+    float mono[256];
+    for (uint32_t i = 0; i < frames; i += 256) {
+        const uint32_t n = std::min<uint32_t>(256, frames - i);
+        if (pitch_input.getWritableDataSize() < sizeof(float) * n) break;
+        for (uint32_t k = 0; k < n; k++)
+            mono[k] = 0.5f * (inputs[0][i + k] + inputs[1][i + k]);
+        pitch_input.writeCustomData(mono, sizeof(float) * n);
+        pitch_input.commitWrite();
+    }
+
+    // the note only moves once the pitch is most of a semitone away, so vibrato doesn't retrigger it
+    fClarity = pitch_clarity.load(std::memory_order_relaxed);
+    if (fClarity >= pitch_min_clarity) {
+        fPitch = pitch_frequency.load(std::memory_order_relaxed);
+        const float note = 12.0f * std::log2(fPitch / 440.0f) + 69.0f;
+        if (fNote == 0.0f || std::fabs(note - fNote) > 0.75f)
+            fNote = std::clamp(std::round(note), 1.0f, 127.0f);
+    } else {
+        fPitch = 0.0f;
+        fNote = 0.0f;
+    }
+
+    const int midi_note = fPitchMidi >= 0.5f && fNote > 0.0f ? static_cast<int>(fNote) : -1;
+    if (midi_note != fMidiNote) {
+        if (fMidiNote >= 0) sendNote(0x80, fMidiNote, 0);
+        if (midi_note >= 0) sendNote(0x90, midi_note, 100);
+        fMidiNote = midi_note;
+    }
+
     if (ring_buffer.getWritableDataSize() >= sizeof(RbMsg)) {
         std::memcpy(rbmsg.buffer_l, inputs[0], sizeof(float) * frames);
         std::memcpy(rbmsg.buffer_r, inputs[1], sizeof(float) * frames);
         rbmsg.length = frames;
+        rbmsg.reset = fNeedsReset;
+        rbmsg.pitch = fPitch;
+        rbmsg.clarity = fClarity;
         ring_buffer.writeCustomType<RbMsg>(rbmsg);
         ring_buffer.commitWrite();
+        fNeedsReset = false;
     }
 
     // copy inputs over outputs if needed
@@ -18,15 +18,24 @@
 #define EXAMPLE_PLUGIN_METERS_HPP
 
 #include "DistrhoPlugin.hpp"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <thread>
 
 #include <extra/RingBuffer.hpp>
 
+#include "pitch.hpp"
+
 struct RbMsg {
     float buffer_l[48000 * sizeof(float) * 2];
     float buffer_r[48000 * sizeof(float) * 2];
     uint32_t length;
+    // set on the first block after a "reset" state, the UI clears its averages there
+    bool reset;
+    // pitch output parameters when the block was processed, 0 Hz while unvoiced
+    float pitch;
+    float clarity;
 };
 
 
@@ -41,6 +50,7 @@ class Spectrogram : public Plugin
 {
 public:
     Spectrogram();
+    ~Spectrogram() override;
 
     HeapRingBuffer ring_buffer;
 
@@ -130,6 +140,18 @@ private:
       Parameters.
     */
     float fColor, fOutLeft, fOutRight;
+    float fPitch, fClarity, fNote, fPitchMidi;
+
+   /**
+      MIDI note currently held when MIDI output is on, -1 for none.
+    */
+    int fMidiNote;
+
+   /**
+      Set when the pitch thread stops with a note held, run() sends its note-off.
+      MIDI can only be written from run().
+    */
+    bool fNoteOffPending;
 
    /**
       Boolean used to reset meter values.
@@ -137,6 +159,23 @@ private:
     */
     bool fNeedsReset;
 
+   /**
+      Pitch tracker, fed a mono mix through pitch_input and run on its own thread since
+      its FFTs allocate. run() only reads the last estimate back from the atomics.
+    */
+    PitchTracker pitch;
+    HeapRingBuffer pitch_input;
+    std::thread pitch_thread;
+    std::atomic<bool> pitch_quit{false};
+    std::atomic<float> pitch_frequency{0.0f};
+    std::atomic<float> pitch_clarity{0.0f};
+    static constexpr float pitch_min_clarity = 0.8f;
+
+    void startPitch();
+    void stopPitch();
+    void pitchLoop();
+    void sendNote(uint8_t status, int note, uint8_t velocity);
+
    /**
       Set our plugin class as non-copyable and add a leak detector just in case.
     */
@@ -24,7 +24,10 @@
 #include <cassert>
 #include <sys/types.h>
 #include <vector>
+#include <deque>
 #include <iostream>
+#include <atomic>
+#include <memory>
 
 #include "DistrhoUtils.hpp"
 #include "NanoVG.hpp"
@@ -36,6 +39,11 @@
 
 #include "SimdUtils.hpp"
 #include "fft.hpp"
+#include "sdft.hpp"
+#include "history.hpp"
+#include "channels.hpp"
+#include "workers.hpp"
+#include "partials.hpp"
 #include "colormaps.hpp"
 
 START_NAMESPACE_DISTRHO
@@ -65,6 +73,12 @@ class SpectrogramUI : public UI,
 {
 public:
 
+    // Window length presets, powers of two and durations in ms (ms is 0 for the former)
+    struct WindowPreset {
+        int length;
+        float ms;
+    };
+
     class DragFloatWindowsize : public DragFloat
     {
     public:
@@ -72,13 +86,178 @@ public:
         : DragFloat(p, cb)
         {
         }
+        std::vector<WindowPreset> presets;
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            const WindowPreset& preset = presets[static_cast<int>(getValue())];
+            if (preset.ms > 0)
+                std::snprintf(dest, 23, "%gms (%d)", preset.ms, preset.length);
+            else
+                std::snprintf(dest, 23, "%d", preset.length);
+        }
+        
+    };
+
+    class DragFloatLength : public DragFloat
+    {
+    public:
+        DragFloatLength(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+        float sampleRate;
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            std::snprintf(dest, 23, "%d (%.1fms)", static_cast<int>(getValue()), getValue() * 1000 / sampleRate);
+        }
+        
+    };
+    
+    class DragFloatTapers : public DragFloat
+    {
+    public:
+        DragFloatTapers(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
     protected:
         virtual void getCustomText(char dest[24]) {
-            std::snprintf(dest, 23, "%d", to_window_size_po2(getValue()));
+            std::snprintf(dest, 23, "%.1f (%d tapers)", getValue(), std::max(1, static_cast<int>(2 * getValue()) - 1));
         }
         
     };
     
+    enum AnalysisMode {
+        kAnalysisSTFT = 0,
+        kAnalysisMel,
+        kAnalysisBark,
+        kAnalysisERB,
+        kAnalysisZoom,
+        kAnalysisCepstrum,
+        kAnalysisInstFreq,
+        kAnalysisGroupDelay,
+        kAnalysisReassign,
+        kAnalysisMultitaper,
+        kAnalysisWavelet,
+        kAnalysisCount
+    };
+
+    class DragFloatAnalysis : public DragFloat
+    {
+    public:
+        DragFloatAnalysis(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kAnalysisCount] = { "STFT", "Mel", "Bark", "ERB", "Zoom", "Cepstrum", "Inst. freq", "Grp delay", "Reassign", "Multitaper", "Wavelet" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    class DragFloatAverage : public DragFloat
+    {
+    public:
+        DragFloatAverage(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kTraceCount] = { "Off", "Exp", "Linear", "Min hold", "Max hold" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    class DragFloatTransfer : public DragFloat
+    {
+    public:
+        DragFloatTransfer(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kTransferCount] = { "Off", "H1", "H2" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    class DragFloatChannels : public DragFloat
+    {
+    public:
+        DragFloatChannels(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kChannelsCount] = { "L / R", "M / S", "L", "R", "M", "S", "Matrix" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    class DragFloatDescriptor : public DragFloat
+    {
+    public:
+        DragFloatDescriptor(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kDescriptorCount] = { "Off", "Centroid", "Spread", "Rolloff 85%", "Rolloff 95%",
+                                                           "Flatness", "Crest", "Flux", "Entropy" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    // Things marked or drawn over the spectrogram, one at a time
+    enum OverlayMode {
+        kOverlayOff = 0,
+        kOverlayHarmonics,
+        kOverlayOnsets,
+        kOverlayPartials,
+        kOverlayLPC,
+        kOverlayCount
+    };
+
+    class DragFloatOverlay : public DragFloat
+    {
+    public:
+        DragFloatOverlay(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kOverlayCount] = { "Off", "Harmonics", "Onsets", "Partials", "LPC" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
+    class DragFloatNoiseFloor : public DragFloat
+    {
+    public:
+        DragFloatNoiseFloor(NanoTopLevelWidget* const p, KnobEventHandler::Callback* const cb)
+        : DragFloat(p, cb)
+        {
+        }
+    protected:
+        virtual void getCustomText(char dest[24]) {
+            static const char* names[kFloorCount] = { "Off", "Gate", "Normalize" };
+            std::snprintf(dest, 23, "%s", names[static_cast<int>(getValue())]);
+        }
+        
+    };
+
     class DragFloatDelay : public DragFloat
     {
     public:
@@ -99,9 +278,20 @@ public:
     };
 
     SpectrogramUI()
-        : UI(1280, 512),
+        : UI(1280, 650),
+          precisionButton(this, this),
+          smoothButton(this, this),
+          resetButton(this, this),
+          psdButton(this, this),
+          exportButton(this, this),
+          alignButton(this, this),
+          pitchButton(this, this),
+          exportPartialsButton(this, this),
+          dbButton(this, this),
           colorsButton(this, this),
-          peakButton(this, this)
+          peakButton(this, this),
+          multiresButton(this, this),
+          trackerButton(this, this)
     {
         #ifdef DGL_NO_SHARED_RESOURCES
         createFontFromFile("sans", "/usr/share/fonts/truetype/ttf-dejavu/DejaVuSans.ttf");
@@ -113,20 +303,22 @@ public:
         
         window_size = 1024;
         topbin = window_size / 2 + 1;
-        window.resize(window_size);
-        hann(window.data(), window_size, true);
-        
-        std::sprintf(topbin_text, "%3.3fHz", freqAtBin(topbin - 1));
-        std::sprintf(botbin_text, "%3.3fHz", freqAtBin(1));
-        
-        columns_l.init(&window, window_size);
-        columns_r.init(&window, window_size);
-        columns_l.fct = 2.0;
-        columns_r.fct = 2.0;
         
         plugin_ptr = reinterpret_cast<Spectrogram*>(getPluginInstancePointer());
-        columns_l.sampleRate = getSampleRate();
-        columns_r.sampleRate = getSampleRate();
+        // init() reads the rate for the lifter, the zoom, the scales and the resolutions
+        forEachColumns([&](auto& cols) {
+            cols.fct = 2.0;
+            cols.sampleRate = getSampleRate();
+            cols.init(windowFor(cols), window_size);
+        });
+
+        binLabel(topbin_text, sizeof(topbin_text), topbin - 1);
+        binLabel(botbin_text, sizeof(botbin_text), 1);
+
+        history_l.init(history_seconds * getSampleRate());
+        history_r.init(history_seconds * getSampleRate());
+        pool.start(std::clamp(std::thread::hardware_concurrency(), 1u, 16u));
+        worker_scratch.resize(pool.size());
 
         dragfloat_pregain = new DragFloat(this, this);
         dragfloat_pregain->setAbsolutePos(15,15);
@@ -138,8 +330,9 @@ public:
 
         dragfloat_windowsize = new DragFloatWindowsize(this, this);
         dragfloat_windowsize->setAbsolutePos(15, 15 + (45*1));
-        dragfloat_windowsize->setRange(0, 7);
-        dragfloat_windowsize->setDefault(from_window_size_po2(window_size));
+        initWindowPresets();
+        dragfloat_windowsize->setRange(0, dragfloat_windowsize->presets.size() - 1);
+        dragfloat_windowsize->setDefault(presetForLength(window_size));
         dragfloat_windowsize->setStep(1);
         dragfloat_windowsize->setUsingCustomText(true);
         dragfloat_windowsize->setValue(dragfloat_windowsize->getDefault(), false);
@@ -150,7 +343,7 @@ public:
         dragfloat_delay->setAbsolutePos(15, 15 + (45*2));
         dragfloat_delay->setRange(0, 8192);
         dragfloat_delay->setDefault(4096);
-        dragfloat_delay->setStep(256);
+        dragfloat_delay->setStep(1);
         dragfloat_delay->setUsingCustomText(true);
         dragfloat_delay->setValue(dragfloat_delay->getDefault(), false);
         dragfloat_delay->label = "Delay";
@@ -200,12 +393,237 @@ public:
         peakButton.setLabel("Peak bins only");
         peakButton.setSize(100, 30);
 
+        multiresButton.setAbsolutePos(15, 18 + (45*9));
+        multiresButton.setLabel("Multi-res");
+        multiresButton.setSize(100, 30);
+
+        dragfloat_transfer = new DragFloatTransfer(this, this);
+        dragfloat_transfer->setAbsolutePos(15, 18 + (45*10));
+        dragfloat_transfer->setRange(0, kTransferCount - 1);
+        dragfloat_transfer->setDefault(kTransferOff);
+        dragfloat_transfer->setStep(1);
+        dragfloat_transfer->setUsingCustomText(true);
+        dragfloat_transfer->setValue(dragfloat_transfer->getDefault(), false);
+        dragfloat_transfer->label = "Transfer";
+        dragfloat_transfer->unit = "";
+        transfer_text[0] = '\0';
+
+        dragfloat_channels = new DragFloatChannels(this, this);
+        dragfloat_channels->setAbsolutePos(15, 18 + (45*11));
+        dragfloat_channels->setRange(0, kChannelsCount - 1);
+        dragfloat_channels->setDefault(kChannelsLR);
+        dragfloat_channels->setStep(1);
+        dragfloat_channels->setUsingCustomText(true);
+        dragfloat_channels->setValue(dragfloat_channels->getDefault(), false);
+        dragfloat_channels->label = "Channels";
+        dragfloat_channels->unit = "";
+
+        alignButton.setAbsolutePos(15, 18 + (45*12));
+        alignButton.setLabel("Auto align");
+        alignButton.setSize(100, 30);
+        align_text[0] = '\0';
+
+        pitchButton.setAbsolutePos(122 + texture_w + 10, strip_y);
+        pitchButton.setLabel("Pitch");
+        pitchButton.setSize(100, 30);
+        pitch_text[0] = '\0';
+
+        dragfloat_descriptor = new DragFloatDescriptor(this, this);
+        dragfloat_descriptor->setAbsolutePos(15, 18 + (45*13));
+        dragfloat_descriptor->setRange(0, kDescriptorCount - 1);
+        dragfloat_descriptor->setDefault(kDescriptorOff);
+        dragfloat_descriptor->setStep(1);
+        dragfloat_descriptor->setUsingCustomText(true);
+        dragfloat_descriptor->setValue(dragfloat_descriptor->getDefault(), false);
+        dragfloat_descriptor->label = "Descriptor";
+        dragfloat_descriptor->unit = "";
+
+        // matrix coefficients, first output on the first row and second output on the second one
+        static const char* matrix_labels[4] = { "1 from L", "1 from R", "2 from L", "2 from R" };
+        for (int k = 0; k < 4; k++) {
+            dragfloat_matrix[k] = new DragFloat(this, this);
+            dragfloat_matrix[k]->setAbsolutePos(128 + 105*(8 + k % 2), k < 2 ? controls_y : controls2_y);
+            dragfloat_matrix[k]->setRange(-2, 2);
+            dragfloat_matrix[k]->setDefault(k == 0 || k == 3 ? 1 : 0);
+            dragfloat_matrix[k]->setStep(0.01);
+            dragfloat_matrix[k]->setValue(dragfloat_matrix[k]->getDefault(), false);
+            dragfloat_matrix[k]->label = matrix_labels[k];
+            dragfloat_matrix[k]->unit = "";
+            dragfloat_matrix[k]->setVisible(false);
+        }
+
+        dragfloat_analysis = new DragFloatAnalysis(this, this);
+        dragfloat_analysis->setAbsolutePos(128, controls_y);
+        dragfloat_analysis->setRange(0, kAnalysisCount - 1);
+        dragfloat_analysis->setDefault(kAnalysisSTFT);
+        dragfloat_analysis->setStep(1);
+        dragfloat_analysis->setUsingCustomText(true);
+        dragfloat_analysis->setValue(dragfloat_analysis->getDefault(), false);
+        dragfloat_analysis->label = "Analysis";
+        dragfloat_analysis->unit = "";
+
+        dragfloat_bands = new DragFloat(this, this);
+        dragfloat_bands->setAbsolutePos(128 + 105, controls_y);
+        dragfloat_bands->setRange(40, 256);
+        dragfloat_bands->setDefault(64);
+        dragfloat_bands->setStep(1);
+        dragfloat_bands->setValue(dragfloat_bands->getDefault(), false);
+        dragfloat_bands->label = "Bands";
+        dragfloat_bands->unit = "";
+
+        // takes the place of Bands in cepstrum mode
+        dragfloat_lifter = new DragFloat(this, this);
+        dragfloat_lifter->setAbsolutePos(128 + 105, controls_y);
+        dragfloat_lifter->setRange(0, 20);
+        dragfloat_lifter->setDefault(1);
+        dragfloat_lifter->setStep(0.1);
+        dragfloat_lifter->setValue(dragfloat_lifter->getDefault(), false);
+        dragfloat_lifter->label = "Lifter";
+        dragfloat_lifter->unit = "ms";
+        dragfloat_lifter->setVisible(false);
+
+        // takes the place of Bands in multitaper mode
+        dragfloat_nw = new DragFloatTapers(this, this);
+        dragfloat_nw->setAbsolutePos(128 + 105, controls_y);
+        dragfloat_nw->setRange(1, 8);
+        dragfloat_nw->setDefault(4);
+        dragfloat_nw->setStep(0.5);
+        dragfloat_nw->setUsingCustomText(true);
+        dragfloat_nw->setValue(dragfloat_nw->getDefault(), false);
+        dragfloat_nw->label = "NW";
+        dragfloat_nw->unit = "";
+        dragfloat_nw->setVisible(false);
+
+        trackerButton.setAbsolutePos(128 + 105*2, controls_y);
+        trackerButton.setLabel("Tracker");
+        trackerButton.setSize(100, 30);
+
+        tracker_l.init(getSampleRate(), window_size, tracker_decimation, texture_w);
+        tracker_r.init(getSampleRate(), window_size, tracker_decimation, texture_w);
+
+        precisionButton.setAbsolutePos(128 + 105*3, controls_y);
+        precisionButton.setLabel("64-bit");
+        precisionButton.setSize(100, 30);
+
+        dragfloat_length = new DragFloatLength(this, this);
+        dragfloat_length->setAbsolutePos(128 + 105*4, controls_y);
+        dragfloat_length->sampleRate = getSampleRate();
+        dragfloat_length->setRange(min_window_size, max_window_size);
+        dragfloat_length->setDefault(window_size);
+        dragfloat_length->setStep(1);
+        dragfloat_length->setUsingLogScale(true);
+        dragfloat_length->setUsingCustomText(true);
+        dragfloat_length->setValue(dragfloat_length->getDefault(), false);
+        dragfloat_length->label = "Length";
+        dragfloat_length->unit = "";
+
+        dbButton.setAbsolutePos(128 + 105*5, controls_y);
+        dbButton.setLabel("dB scale");
+        dbButton.setSize(100, 30);
+
+        dragfloat_floor = new DragFloat(this, this);
+        dragfloat_floor->setAbsolutePos(128 + 105*6, controls_y);
+        dragfloat_floor->setRange(-200, -20);
+        dragfloat_floor->setDefault(db_floor);
+        dragfloat_floor->setStep(1);
+        dragfloat_floor->setValue(dragfloat_floor->getDefault(), false);
+        dragfloat_floor->label = "Floor";
+        dragfloat_floor->unit = "dB";
+
+        dragfloat_ceiling = new DragFloat(this, this);
+        dragfloat_ceiling->setAbsolutePos(128 + 105*7, controls_y);
+        dragfloat_ceiling->setRange(-60, 20);
+        dragfloat_ceiling->setDefault(db_ceiling);
+        dragfloat_ceiling->setStep(1);
+        dragfloat_ceiling->setValue(dragfloat_ceiling->getDefault(), false);
+        dragfloat_ceiling->label = "Ceiling";
+        dragfloat_ceiling->unit = "dB";
+
+        dragfloat_average = new DragFloatAverage(this, this);
+        dragfloat_average->setAbsolutePos(128, controls2_y);
+        dragfloat_average->setRange(0, kTraceCount - 1);
+        dragfloat_average->setDefault(kTraceOff);
+        dragfloat_average->setStep(1);
+        dragfloat_average->setUsingCustomText(true);
+        dragfloat_average->setValue(dragfloat_average->getDefault(), false);
+        dragfloat_average->label = "Average";
+        dragfloat_average->unit = "";
+
+        dragfloat_frames = new DragFloat(this, this);
+        dragfloat_frames->setAbsolutePos(128 + 105, controls2_y);
+        dragfloat_frames->setRange(1, 256);
+        dragfloat_frames->setDefault(16);
+        dragfloat_frames->setStep(1);
+        dragfloat_frames->setValue(dragfloat_frames->getDefault(), false);
+        dragfloat_frames->label = "Frames";
+        dragfloat_frames->unit = "";
+
+        dragfloat_decay = new DragFloat(this, this);
+        dragfloat_decay->setAbsolutePos(128 + 105*2, controls2_y);
+        dragfloat_decay->setRange(0, 120);
+        dragfloat_decay->setDefault(20);
+        dragfloat_decay->setStep(1);
+        dragfloat_decay->setValue(dragfloat_decay->getDefault(), false);
+        dragfloat_decay->label = "Hold decay";
+        dragfloat_decay->unit = "dB/s";
+
+        smoothButton.setAbsolutePos(128 + 105*3, controls2_y);
+        smoothButton.setLabel("Smooth view");
+        smoothButton.setSize(100, 30);
+
+        resetButton.setAbsolutePos(128 + 105*4, controls2_y);
+        resetButton.setLabel("Reset");
+        resetButton.setSize(100, 30);
+
+        psdButton.setAbsolutePos(128 + 105*5, controls2_y);
+        psdButton.setLabel("Welch PSD");
+        psdButton.setSize(100, 30);
+
+        exportButton.setAbsolutePos(128 + 105*6, controls2_y);
+        exportButton.setLabel("Export PSD");
+        exportButton.setSize(100, 30);
+
+        exportPartialsButton.setAbsolutePos(128 + 105*10, controls2_y);
+        exportPartialsButton.setLabel("Export partials");
+        exportPartialsButton.setSize(100, 30);
+
+        // takes the place of Export partials with the LPC overlay, 2 + kHz is the usual order
+        dragfloat_lpc_order = new DragFloat(this, this);
+        dragfloat_lpc_order->setAbsolutePos(128 + 105*10, controls2_y);
+        dragfloat_lpc_order->setRange(8, LinearPrediction::max_order);
+        dragfloat_lpc_order->setDefault(std::clamp(2 + static_cast<int>(getSampleRate() / 1000), 8, static_cast<int>(LinearPrediction::max_order)));
+        dragfloat_lpc_order->setStep(1);
+        dragfloat_lpc_order->setValue(dragfloat_lpc_order->getDefault(), false);
+        dragfloat_lpc_order->label = "Order";
+        dragfloat_lpc_order->unit = "";
+        dragfloat_lpc_order->setVisible(false);
+
+        dragfloat_overlay = new DragFloatOverlay(this, this);
+        dragfloat_overlay->setAbsolutePos(128 + 105*7, controls2_y);
+        dragfloat_overlay->setRange(0, kOverlayCount - 1);
+        dragfloat_overlay->setDefault(kOverlayOff);
+        dragfloat_overlay->setStep(1);
+        dragfloat_overlay->setUsingCustomText(true);
+        dragfloat_overlay->setValue(dragfloat_overlay->getDefault(), false);
+        dragfloat_overlay->label = "Overlay";
+        dragfloat_overlay->unit = "";
+
+        dragfloat_noise_floor = new DragFloatNoiseFloor(this, this);
+        dragfloat_noise_floor->setAbsolutePos(128 + 105*10, controls_y);
+        dragfloat_noise_floor->setRange(0, kFloorCount - 1);
+        dragfloat_noise_floor->setDefault(kFloorOff);
+        dragfloat_noise_floor->setStep(1);
+        dragfloat_noise_floor->setUsingCustomText(true);
+        dragfloat_noise_floor->setValue(dragfloat_noise_floor->getDefault(), false);
+        dragfloat_noise_floor->label = "Noise floor";
+        dragfloat_noise_floor->unit = "";
+
         initBinAtCursor();
 
         if (!nimg.isValid())
             initSpectrogramTexture();
 
-        setGeometryConstraints(900, 512, false);
+        setGeometryConstraints(900, 650, false);
     }
     
     char names[12][3] = { "C ", "C#", "D ", "Eb", "E ", "F ", "F#", "G ", "G#", "A ", "Bb", "B "};
@@ -221,9 +639,27 @@ public:
     DragFloat* dragfloat_botbin;
     DragFloat* dragfloat_multiplier;
     DragFloat* dragfloat_threshold;
+    DragFloatAnalysis* dragfloat_analysis;
+    DragFloat* dragfloat_bands;
+    DragFloat* dragfloat_lifter;
+    DragFloat* dragfloat_nw;
+    DragFloat* dragfloat_lpc_order;
+    DragFloatLength* dragfloat_length;
+    DragFloat* dragfloat_floor;
+    DragFloat* dragfloat_ceiling;
+    DragFloatAverage* dragfloat_average;
+    DragFloat* dragfloat_frames;
+    DragFloat* dragfloat_decay;
+    DragFloatTransfer* dragfloat_transfer;
+    DragFloatChannels* dragfloat_channels;
+    DragFloatDescriptor* dragfloat_descriptor;
+    DragFloat* dragfloat_matrix[4];
+    DragFloatOverlay* dragfloat_overlay;
+    DragFloatNoiseFloor* dragfloat_noise_floor;
 
-    std::vector<float> window;
     int window_size;
+    static constexpr int min_window_size = 64;
+    static constexpr int max_window_size = 32768;
 
 protected:
    /* --------------------------------------------------------------------------------------------------------
@@ -257,6 +693,228 @@ protected:
     bool request_raster_all = false;
     int since_last_raster = -1;
     int requested_window_size = -1;
+    bool requested_analysis = false;
+
+    // Rebuild window, filterbank and columns for the current settings, history is dropped
+    // since columns of different sizes can't be rastered together
+    void applyAnalysisSettings()
+    {
+        // the columns are about to be rebuilt, no catching up
+        pool.cancel();
+        reanalysis.active = false;
+
+        int mode = static_cast<int>(dragfloat_analysis->getValue());
+        Filterbank* bank = nullptr;
+        if (mode >= kAnalysisMel && mode <= kAnalysisERB) {
+            filterbank.init(static_cast<FilterbankScale>(mode - kAnalysisMel), static_cast<int>(dragfloat_bands->getValue()), window_size, getSampleRate());
+            bank = &filterbank;
+        }
+
+        dragfloat_bands->setVisible(mode != kAnalysisCepstrum && mode != kAnalysisMultitaper);
+        dragfloat_lifter->setVisible(mode == kAnalysisCepstrum);
+        dragfloat_nw->setVisible(mode == kAnalysisMultitaper);
+
+        forEachColumns([&](auto& cols) {
+            cols.columns.clear();
+            cols.filterbank = bank;
+            cols.cepstral = mode == kAnalysisCepstrum;
+            cols.lifter_seconds = dragfloat_lifter->getValue() / 1000.0f;
+            cols.deriving = mode >= kAnalysisInstFreq && mode <= kAnalysisReassign
+                ? static_cast<PhaseDerivative>(kDeriveFrequency + mode - kAnalysisInstFreq) : kDeriveOff;
+            cols.multitaper = mode == kAnalysisMultitaper;
+            cols.taper_nw = dragfloat_nw->getValue();
+            cols.scale_pool = &pool;
+            cols.init(windowFor(cols), window_size, hopSize());
+            cols.setZoom(mode == kAnalysisZoom, zoom_lo, zoom_hi);
+            cols.setScalogram(mode == kAnalysisWavelet, static_cast<int>(dragfloat_bands->getValue()));
+        });
+
+        tracker_l.init(getSampleRate(), window_size, tracker_decimation, texture_w);
+        tracker_r.init(getSampleRate(), window_size, tracker_decimation, texture_w);
+        updateMeasurementSettings();
+        resetOnsets();
+        resetPartials();
+
+        topbin = binCount();
+        dragfloat_topbin->setRange(2, binCount());
+        dragfloat_topbin->setValue(topbin);
+        botbin = 0;
+        dragfloat_botbin->setRange(0, binCount());
+        dragfloat_botbin->setValue(botbin);
+
+        initSpectrogramTexture();
+        updateSpectrogramTexture();
+
+        binLabel(topbin_text, sizeof(topbin_text), topbin == binCount() ? topbin - 1 : topbin);
+        binLabel(botbin_text, sizeof(botbin_text), botbin == 0 ? 1 : botbin);
+        updateTrackerFrequencies();
+
+        withColumns([&](auto& cols_l, auto& cols_r) { startReanalysis(cols_l, cols_r); });
+    }
+
+    // Stored audio is analysed again with the new settings instead of starting from an empty
+    // view: one slot per frame is allocated up front and chunks of frames, newest first, are
+    // spread over the worker pool. The stream is held back meanwhile and catches up from the
+    // history once done, so nothing moves the slots while workers write into them.
+    // Buffers owned by one re-analysis worker
+    struct WorkerScratch {
+        Columns<float>::Scratch scratch;
+        Columns<double>::Scratch scratch_d;
+        std::vector<float> frame;
+        std::vector<double> frame_d;
+        // history is raw L/R, the channel matrix is applied per frame
+        std::vector<float> in_l;
+        std::vector<float> in_r;
+        std::vector<float> first;
+        std::vector<float> second;
+
+        Columns<float>::Scratch& scratchFor(const Columns<float>&) { return scratch; }
+        Columns<double>::Scratch& scratchFor(const Columns<double>&) { return scratch_d; }
+        std::vector<float>& frameFor(const Columns<float>&) { return frame; }
+        std::vector<double>& frameFor(const Columns<double>&) { return frame_d; }
+    };
+    std::vector<WorkerScratch> worker_scratch;
+
+    struct Reanalysis {
+        bool active = false;
+        uint64_t first_sample;
+        size_t frames;
+        size_t chunks;
+        // chunks handed to the raster so far, newest first, only ever touched here
+        size_t marked;
+        std::unique_ptr<std::atomic<bool>[]> chunk_done;
+    };
+    Reanalysis reanalysis;
+    static constexpr size_t reanalysis_chunk = 8;
+    // audio that may arrive while re-analysing, older frames aren't used in case they get overwritten
+    static constexpr float reanalysis_guard_seconds = 2.0f;
+
+    template <typename T>
+    void startReanalysis(Columns<T>& cols_l, Columns<T>& cols_r)
+    {
+        const uint64_t end = history_l.end();
+        const uint64_t begin = history_l.beginAfter(reanalysis_guard_seconds * getSampleRate());
+        // the zoom filter and the wavelet blocks are streams, they start over
+        if (cols_l.zoomed || cols_l.scalogram || end < begin + cols_l.window_size) return;
+
+        const uint32_t N = cols_l.window_size;
+        const uint32_t hop = cols_l.hop_size;
+        reanalysis.frames = std::min<uint64_t>((end - begin - N) / hop + 1, cols_l.columns_memory_size / 2);
+        reanalysis.first_sample = end - N - (reanalysis.frames - 1) * hop;
+        reanalysis.chunks = (reanalysis.frames + reanalysis_chunk - 1) / reanalysis_chunk;
+        reanalysis.marked = 0;
+        reanalysis.chunk_done.reset(new std::atomic<bool>[reanalysis.chunks]);
+        for (size_t c = 0; c < reanalysis.chunks; c++) reanalysis.chunk_done[c].store(false);
+        reanalysis.active = true;
+
+        typename Columns<T>::Column empty(cols_l.outputSize());
+        cols_l.columns.assign(reanalysis.frames, empty);
+        cols_r.columns.assign(reanalysis.frames, empty);
+
+        pool.submit(reanalysis.chunks, [this, &cols_l, &cols_r](size_t chunk, size_t worker) {
+            analyzeChunk(cols_l, cols_r, chunk, worker_scratch[worker]);
+        });
+    }
+
+    // Runs on a worker: reads the history and writes the chunk's slots, nothing else
+    template <typename T>
+    void analyzeChunk(Columns<T>& cols_l, Columns<T>& cols_r, size_t chunk, WorkerScratch& ws)
+    {
+        auto& scratch = ws.scratchFor(cols_l);
+        auto& frame = ws.frameFor(cols_l);
+        const size_t N = cols_l.window_size;
+        frame.resize(N);
+        for (auto* v : { &ws.in_l, &ws.in_r, &ws.first, &ws.second }) v->resize(N);
+
+        const size_t hi = reanalysis.frames - chunk * reanalysis_chunk;
+        const size_t lo = hi > reanalysis_chunk ? hi - reanalysis_chunk : 0;
+        for (size_t f = hi; f-- > lo;)
+        {
+            const uint64_t pos = reanalysis.first_sample + static_cast<uint64_t>(f) * cols_l.hop_size;
+            history_l.read(pos, ws.in_l.data(), N);
+            history_r.read(pos, ws.in_r.data(), N);
+            channels.apply(ws.in_l.data(), ws.in_r.data(), ws.first.data(), ws.second.data(), N);
+            std::copy(ws.first.begin(), ws.first.end(), frame.begin());
+            cols_l.analyze(frame.data(), cols_l.columns[f], scratch);
+            if (channels.single) continue;
+            std::copy(ws.second.begin(), ws.second.end(), frame.begin());
+            cols_r.analyze(frame.data(), cols_r.columns[f], scratch);
+        }
+        reanalysis.chunk_done[chunk].store(true, std::memory_order_release);
+    }
+
+    // Marks finished chunks as processed in order so the view fills from the right
+    template <typename T>
+    void pollReanalysis(Columns<T>& cols_l, Columns<T>& cols_r)
+    {
+        bool any = false;
+        while (reanalysis.marked < reanalysis.chunks && reanalysis.chunk_done[reanalysis.marked].load(std::memory_order_acquire))
+        {
+            const size_t hi = reanalysis.frames - reanalysis.marked * reanalysis_chunk;
+            const size_t lo = hi > reanalysis_chunk ? hi - reanalysis_chunk : 0;
+            for (size_t f = lo; f < hi; f++)
+            {
+                cols_l.columns[f].processed = true;
+                cols_r.columns[f].processed = true;
+            }
+            // phase derivatives want the column before too, same wait
+            if (cols_l.deriving != kDeriveOff) {
+                for (size_t f = lo == 0 ? 0 : lo + 1; f <= std::min(hi, reanalysis.frames - 1); f++)
+                {
+                    cols_l.deriveAnalysed(cols_l.columns[f], f > 0 ? &cols_l.columns[f - 1] : nullptr);
+                    if (!channels.single) cols_r.deriveAnalysed(cols_r.columns[f], f > 0 ? &cols_r.columns[f - 1] : nullptr);
+                }
+            }
+            // flux wants the column before, the oldest one of the chunk waits for the next chunk
+            if (cols_l.describing) {
+                for (size_t f = lo + 1; f <= std::min(hi, reanalysis.frames - 1); f++)
+                {
+                    cols_l.describeFlux(cols_l.columns[f], cols_l.columns[f - 1]);
+                    cols_r.describeFlux(cols_r.columns[f], cols_r.columns[f - 1]);
+                }
+            }
+            reanalysis.marked++;
+            any = true;
+        }
+        if (any) request_raster_all = true;
+        if (reanalysis.marked == reanalysis.chunks) finishReanalysis(cols_l, cols_r);
+    }
+
+    // Stops the workers, slots they didn't get to stay black, then feeds what arrived meanwhile
+    template <typename T>
+    void finishReanalysis(Columns<T>& cols_l, Columns<T>& cols_r)
+    {
+        pool.cancel();
+        reanalysis.active = false;
+
+        const uint64_t next = std::max(history_l.begin(), reanalysis.first_sample + reanalysis.frames * cols_l.hop_size);
+        const size_t length = history_l.end() - next;
+        history_frame.resize(length);
+        history_frame_r.resize(length);
+        history_l.read(next, history_frame.data(), length);
+        history_r.read(next, history_frame_r.data(), length);
+        float* first = history_frame.data();
+        float* second = history_frame_r.data();
+        if (!channels.identity) {
+            matrixChannels(first, second, length);
+            first = matrixed_first.data();
+            second = matrixed_second.data();
+        }
+        // the floor is a stream, it runs over the re-analysed columns in order
+        if (cols_l.flooring != kFloorOff) {
+            cols_l.applyFloorAll();
+            if (!channels.single) cols_r.applyFloorAll();
+        }
+        feedChannels(cols_l, cols_r, first, second, length);
+        request_raster_all = true;
+    }
+
+    void stopReanalysis()
+    {
+        if (reanalysis.active)
+            withColumns([&](auto& cols_l, auto& cols_r) { finishReanalysis(cols_l, cols_r); });
+    }
+
     void onNanoDisplay() override
     {
         const float lineHeight = 1.5;
@@ -267,28 +925,17 @@ protected:
 
         if (requested_window_size > 0) {
             window_size = requested_window_size;
-            window.resize(window_size);
-            hann(window.data(), window_size, true);
-            columns_l.columns.clear();
-            columns_l.init(&window, window_size);
-            columns_r.columns.clear();
-            columns_r.init(&window, window_size);
             requested_window_size = -1;
-
-            topbin = (window_size / 2 + 1);
-            dragfloat_topbin->setRange(2, (window_size / 2 + 1));
-            dragfloat_topbin->setValue(topbin);
-            botbin = 0;
-            dragfloat_botbin->setRange(0, (window_size / 2 + 1));
-            dragfloat_botbin->setValue(botbin);
-
-            initSpectrogramTexture();
-            updateSpectrogramTexture();
-
-            std::sprintf(topbin_text, "%3.3fHz", freqAtBin(topbin == window_size / 2 + 1 ? topbin - 1 : topbin));
-            std::sprintf(botbin_text, "%3.3fHz", freqAtBin(botbin == 0 ? 1 : botbin));
+            applyAnalysisSettings();
+        }
+        if (requested_analysis) {
+            requested_analysis = false;
+            applyAnalysisSettings();
         }
 
+        if (reanalysis.active)
+            withColumns([&](auto& cols_l, auto& cols_r) { pollReanalysis(cols_l, cols_r); });
+
         if (request_raster_all && (since_last_raster > 4)) {
             rasterAllColumns();
             request_raster_all = false;
@@ -319,13 +966,52 @@ protected:
             stroke();
         }
 
+        if (tracking)
+            drawTrackerStrip(128, strip_y);
+
+        if (traceMode() != kTraceOff)
+            withViewColumns([&](auto& cols_l, auto& cols_r) { drawTraceOverlay(cols_l, cols_r, 128, 16); });
+
+        if (welching)
+            withViewColumns([&](auto& cols_l, auto& cols_r) { drawPSDOverlay(cols_l, cols_r, 128, 16); });
+
+        if (transferMode() != kTransferOff)
+            drawTransferOverlay(128, 16);
+
+        if (descriptorKind() != kDescriptorOff)
+            withViewColumns([&](auto& cols_l, auto& cols_r) { drawDescriptorCurves(cols_l, cols_r, 128, 16); });
+
+        if (overlayMode() == kOverlayHarmonics)
+            withViewColumns([&](auto& cols_l, auto&) { drawHarmonicText(cols_l, 128, 16); });
+
+        if (overlayMode() == kOverlayOnsets)
+            withViewColumns([&](auto& cols_l, auto&) { drawOnsets(cols_l, 128, 16); });
+
+        if (overlayMode() == kOverlayPartials)
+            drawPartials(128, 16);
+
+        if (overlayMode() == kOverlayLPC)
+            withViewColumns([&](auto& cols_l, auto&) { drawLPC(cols_l, 128, 16); });
+
+        if (aligning) {
+            fillColor(Color(1.f, 1.f, 1.f));
+            text(15, 18 + (45*12) + 42, align_text, nullptr);
+        }
+
+        if (pitching) {
+            withViewColumns([&](auto& cols_l, auto&) { drawPitchCurve(cols_l, 128, 16); });
+            updatePitchText();
+            fillColor(Color(1.f, 1.f, 1.f));
+            textBox(122 + texture_w + 10, strip_y + 48, 150, pitch_text, nullptr);
+        }
+
         text(122 + texture_w + 10, 16 + 10, topbin_text, nullptr);
         text(122 + texture_w + 10, 16 + texture_h, botbin_text, nullptr);
 
         textBox(122 + texture_w + 10, 16 + (texture_h/8), 150, cursor_text, nullptr);
 
         if (frozen) {
-            text(128 + (texture_w/2), 500, frozen_text, nullptr);
+            text(128 + (texture_w/2), 16 + 20, frozen_text, nullptr);
         }
     }
 
@@ -361,12 +1047,24 @@ protected:
     BufferOffset buffer_r;
     BufferOffset buffer_l;
 
+    // What was fed to the columns, after pre-gain and delay
+    static constexpr float history_seconds = 60.0f;
+    AudioHistory history_l;
+    AudioHistory history_r;
+    std::vector<float> history_frame;
+    std::vector<float> history_frame_r;
+
+
     int processRingBuffer()
     {
         int n = 0;
         while (plugin_ptr->ring_buffer.getReadableDataSize() >= sizeof(RbMsg)) {
             RbMsg rbmsg = RbMsg();
             if (plugin_ptr->ring_buffer.readCustomType<RbMsg>(rbmsg)) {
+                if (rbmsg.reset) {
+                    forEachColumns([](auto& cols) { cols.traces.reset(); cols.welch.reset(); });
+                    transfer.reset();
+                }
                 if (frozen) continue;
                 if (dragfloat_pregain->getValue() != 0.0f) {
                     simd_buffer_dbgain(rbmsg.buffer_l, rbmsg.length, dragfloat_pregain->getValue());
@@ -374,22 +1072,45 @@ protected:
                 }
                 buffer_r.process(rbmsg.buffer_r, rbmsg.length);
                 buffer_l.process(rbmsg.buffer_l, rbmsg.length);
-                n = columns_l.feed(buffer_l.buffer.data(), rbmsg.length);
-                n = columns_r.feed(buffer_r.buffer.data(), rbmsg.length);
-                auto l_data = columns_l.columns.data();
-                auto r_data = columns_r.columns.data();
-                if (n > 0) {
-                    shiftRasteredColumns((n_columns), column_w, n);
-                    for (int i = 0; i < n; i++) {
-                        if (colorsId < 6) {
-                            rasterColumnMaxLR<texture_w, texture_h>(l_data[columns_l.columns.size() - n + i], r_data[columns_l.columns.size() - n + i],  (((n_columns) - n + i) * column_w), column_w, texture_l, texture_r);
-                        } else {
-                            rasterColumnAddLR<texture_w, texture_h>(l_data[columns_l.columns.size() - n + i], r_data[columns_l.columns.size() - n + i], (((n_columns) - n + i) * column_w), column_w, texture_l, texture_r, false);
+                if (reanalysis.active && history_l.beginAfter(rbmsg.length) > reanalysis.first_sample)
+                    stopReanalysis();
+                history_l.write(buffer_l.buffer.data(), rbmsg.length);
+                history_r.write(buffer_r.buffer.data(), rbmsg.length);
+                pitch_track.push_back({ history_l.end(), rbmsg.pitch, rbmsg.clarity });
+                while (pitch_track.front().end < history_l.begin()) pitch_track.pop_front();
+                float* first = buffer_l.buffer.data();
+                float* second = buffer_r.buffer.data();
+                if (!channels.identity) {
+                    matrixChannels(first, second, rbmsg.length);
+                    first = matrixed_first.data();
+                    second = channels.single ? first : matrixed_second.data();
+                }
+                if (tracking) {
+                    tracker_l.process(first, rbmsg.length);
+                    tracker_r.process(second, rbmsg.length);
+                }
+                if (reanalysis.active) continue;
+                withColumns([&](auto& cols_l, auto& cols_r) {
+                    n = feedChannels(cols_l, cols_r, first, second, rbmsg.length);
+                    if (transferMode() != kTransferOff || aligning)
+                        measureSpectra(cols_l, cols_r, n);
+                });
+                withViewColumns([&](auto& cols_l, auto& cols_r) {
+                    auto l_data = cols_l.columns.data();
+                    auto r_data = cols_r.columns.data();
+                    if (n > 0) {
+                        shiftRasteredColumns((n_columns), column_w, n);
+                        for (int i = 0; i < n; i++) {
+                            if (colorsId < 6) {
+                                rasterColumnMaxLR<texture_w, texture_h>(l_data[cols_l.columns.size() - n + i], r_data[cols_l.columns.size() - n + i],  (((n_columns) - n + i) * column_w), column_w, texture_l, texture_r);
+                            } else {
+                                rasterColumnAddLR<texture_w, texture_h>(l_data[cols_l.columns.size() - n + i], r_data[cols_l.columns.size() - n + i], (((n_columns) - n + i) * column_w), column_w, texture_l, texture_r, false);
+                            }
                         }
+                        updateSpectrogramTexture();
+                        repaint();
                     }
-                    updateSpectrogramTexture();
-                    repaint();
-                }
+                });
             }
         }
         return n;
@@ -399,9 +1120,10 @@ protected:
     Point<float> cursor2;
     char cursor_text[256];
     char cursor2_text[128];
-    Columns::Column colAtCursor(Point<float> cursor, bool leftOrRight)
+    template <typename T>
+    const typename Columns<T>::Column& colAtCursor(const Columns<T>& cols, Point<float> cursor)
     {
-        auto columns_size = columns_l.columns.size();
+        auto columns_size = cols.columns.size();
 
         int cur_col = cursor.getX()/(column_w);
 
@@ -422,7 +1144,7 @@ protected:
         }
         at = std::min(static_cast<int>(columns_size - 1), at);
 
-        return !leftOrRight ? columns_l.columns.at(at) : columns_r.columns.at(at);
+        return cols.columns.at(at);
     }
 
     void initBinAtCursor()
@@ -438,27 +1160,36 @@ protected:
 
     void updateBinAtCursor()
     {
-        auto c_l = colAtCursor(cursor1, 0);
-        auto c_r = colAtCursor(cursor1, 1);
-        
+        if (reanalysis.active) return;
+        withViewColumns([&](auto& cols_l, auto& cols_r) {
+            updateBinAtCursor(colAtCursor(cols_l, cursor1), colAtCursor(cols_r, cursor1));
+        });
+    }
+
+    template <typename C>
+    void updateBinAtCursor(const C& c_l, const C& c_r)
+    {
+
         int cur_col = cursor1.getX()/(column_w);
         int cur_bin = botbin + static_cast<int>(std::floor((texture_h - cursor1.getY()) / (texture_h / static_cast<float>(topbin - botbin))));
+        char bin_text[32];
+        binLabel(bin_text, sizeof(bin_text), cur_bin);
 
         if (cursor2.getY() > 1 || cursor2.getY() < texture_h) {
             auto fc2 = freqAtBin(cursor2_bin);
             auto fc2_n = fton(fc2);
             std::snprintf(cursor_text, 256,
-                    "Cursor:\n%3.3fHz %s%d\n\nMouse\ncol: %d bin: %d\nFrequency:\n%3.3fHz\n\nLEFT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f\n\nRIGHT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f",
+                    "Cursor:\n%3.3fHz %s%d\n\nMouse\ncol: %d bin: %d\nFrequency:\n%s\n\nLEFT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f\n\nRIGHT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f",
                     fc2, names[static_cast<int>(fc2_n) % 12], static_cast<int>(fc2_n/12.0 - 1), cur_col, cur_bin,
-                    freqAtBin(cur_bin),
+                    bin_text,
                     c_l.peakFrequency, c_l.bins[cur_bin], c_l.bins_phase[cur_bin],
                     c_r.peakFrequency, c_r.bins[cur_bin], c_r.bins_phase[cur_bin]
             );
         } else {
             std::snprintf(cursor_text, 256,
-                    "Cursor:\n---------\n\nMouse\ncol: %d bin: %d\nFrequency:\n%3.3fHz\n\nLEFT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f\n\nRIGHT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f",
+                    "Cursor:\n---------\n\nMouse\ncol: %d bin: %d\nFrequency:\n%s\n\nLEFT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f\n\nRIGHT\nPeak:%3.3fHz\nmag: %.3f\nphase: %.3f",
                     cur_col, cur_bin,
-                    freqAtBin(cur_bin),
+                    bin_text,
                     c_l.peakFrequency, c_l.bins[cur_bin], c_l.bins_phase[cur_bin],
                     c_r.peakFrequency, c_r.bins[cur_bin], c_r.bins_phase[cur_bin]
             );
@@ -467,9 +1198,17 @@ protected:
     
     void rasterAllColumns()
     {
-        auto l_data = columns_l.columns;
-        auto r_data = columns_r.columns;
-        auto columns_size = columns_l.columns.size();
+        withViewColumns([&](auto& cols_l, auto& cols_r) { rasterAllColumns(cols_l, cols_r); });
+        updateSpectrogramTexture();
+        repaint();
+    }
+
+    template <typename T>
+    void rasterAllColumns(const Columns<T>& cols_l, const Columns<T>& cols_r)
+    {
+        const auto& l_data = cols_l.columns;
+        const auto& r_data = cols_r.columns;
+        auto columns_size = cols_l.columns.size();
         int start_col = 0;
         int end_col = n_columns;
         if (columns_size < n_columns)
@@ -485,14 +1224,11 @@ protected:
                 rasterColumnAddLR<texture_w, texture_h>(l_data.at(col_x), r_data.at(col_x), ((i + start_col) * column_w), column_w, texture_l, texture_r, false);
             }
         }
-
-        updateSpectrogramTexture();
-        repaint();
     }
 
     void uiIdle() override
     {
-        if (processRingBuffer())
+        if (processRingBuffer() || tracking || reanalysis.active)
             repaint();
         
         if (window_size >= 4096)
@@ -502,7 +1238,8 @@ protected:
     DGL::Rectangle<double> texture_rect = Rectangle<double>(128, 16, texture_w, texture_h);
     bool frozen = false;
 
-    int cursor2_bin;
+    int cursor2_bin = 0;
+    bool cursor2_placed = false;
    /**
       Mouse events.
     */
@@ -511,7 +1248,7 @@ protected:
         if (texture_rect.contains(ev.pos))
         {
 
-            if ((ev.pos.getX() - texture_rect.getX()) < 0 || columns_l.columns.size() < 1) {
+            if ((ev.pos.getX() - texture_rect.getX()) < 0 || columnsCount() < 1) {
                 initBinAtCursor();
             } else {
                 cursor1.setX(ev.pos.getX() - texture_rect.getX());
@@ -522,6 +1259,7 @@ protected:
                 cursor2.setY(ev.pos.getY() - texture_rect.getY());
                 cursor2_bin = botbin + static_cast<int>(std::floor((texture_h - cursor2.getY()) / (texture_h / static_cast<float>(topbin - botbin))));
                 updateBinAtCursor();
+                updateTrackerFrequencies();
             }
         }
         repaint();
@@ -539,41 +1277,143 @@ protected:
         }
         else
         {
-            auto l_data = columns_l.columns;
-            auto r_data = columns_r.columns;
-            auto columns_size = columns_l.columns.size();
-            int start_col = 0;
-            int end_col = n_columns;
-            if (columns_size < n_columns)
-            {
-                start_col = n_columns - columns_size;
-                end_col = columns_size;
+            stopReanalysis();
+            withViewColumns([&](auto& cols_l, auto& cols_r) { dumpToCSV(datFile, cols_l, cols_r); });
+            fclose(datFile);
+        }
+    }
+
+    template <typename T>
+    void dumpToCSV(FILE* datFile, const Columns<T>& cols_l, const Columns<T>& cols_r)
+    {
+        const auto& l_data = cols_l.columns;
+        const auto& r_data = cols_r.columns;
+        auto columns_size = cols_l.columns.size();
+        int start_col = 0;
+        int end_col = n_columns;
+        if (columns_size < n_columns)
+        {
+            start_col = n_columns - columns_size;
+            end_col = columns_size;
+        }
+        for (int i = 0; i < end_col; i++) {
+            auto col_x = (columns_size < n_columns) ? i : (columns_size - n_columns + i);
+            const auto& col_l = l_data.at(col_x);
+            const auto& col_r = r_data.at(col_x);
+            fprintf(datFile, "%04d_left_mag,", i);
+            for (int j = 0; j < col_l.size; j++) {
+                fprintf(datFile, "%f,", col_l.bins[j]);
             }
-            for (int i = 0; i < end_col; i++) {
-                auto col_x = (columns_size < n_columns) ? i : (columns_size - n_columns + i);
-                Columns::Column col_l = l_data.at(col_x);
-                Columns::Column col_r = r_data.at(col_x);
-                fprintf(datFile, "%04d_left_mag,", i);
-                for (int j = 0; j < col_l.size; j++) {
-                    fprintf(datFile, "%f,", col_l.bins[j]);
-                }
-                fprintf(datFile, "\n");
-                fprintf(datFile, "%04d_left_phase,", i);
-                for (int j = 0; j < col_l.size; j++) {
-                    fprintf(datFile, "%f,", col_l.bins_phase[j]);
-                }
-                fprintf(datFile, "\n");
-                fprintf(datFile, "%04d_right_mag,", i);
-                for (int j = 0; j < col_l.size; j++) {
-                    fprintf(datFile, "%f,", col_r.bins[j]);
-                }
-                fprintf(datFile, "\n");
-                fprintf(datFile, "%04d_right_phase,", i);
-                for (int j = 0; j < col_l.size; j++) {
-                    fprintf(datFile, "%f,", col_r.bins_phase[j]);
+            fprintf(datFile, "\n");
+            fprintf(datFile, "%04d_left_phase,", i);
+            for (int j = 0; j < col_l.size; j++) {
+                fprintf(datFile, "%f,", col_l.bins_phase[j]);
+            }
+            fprintf(datFile, "\n");
+            fprintf(datFile, "%04d_right_mag,", i);
+            for (int j = 0; j < col_l.size; j++) {
+                fprintf(datFile, "%f,", col_r.bins[j]);
+            }
+            fprintf(datFile, "\n");
+            fprintf(datFile, "%04d_right_phase,", i);
+            for (int j = 0; j < col_l.size; j++) {
+                fprintf(datFile, "%f,", col_r.bins_phase[j]);
+            }
+            fprintf(datFile, "\n");
+            if (cols_l.describing) {
+                // centroid, spread, rolloff 85%, rolloff 95%, flatness, crest, flux, entropy
+                for (const auto* col : { &col_l, &col_r }) {
+                    fprintf(datFile, "%04d_%s_descriptors,", i, col == &col_l ? "left" : "right");
+                    for (int k = kDescriptorCentroid; k < kDescriptorCount; k++) {
+                        fprintf(datFile, "%f,", descriptorValue(col->descriptors, static_cast<DescriptorKind>(k)));
+                    }
+                    fprintf(datFile, "\n");
                 }
-                fprintf(datFile, "\n");
             }
+        }
+    }
+
+    // Binary Welch PSD dump, little endian:
+    //   char[4] "WPSD", uint32 version (1), float64 sample rate, uint32 window size, uint32 hop,
+    //   uint64 frames, float64 ENBW in bins, uint32 bins, uint32 channels (2),
+    //   then float64 dBFS/Hz per bin for the left channel, then the right one.
+    // Bin k is at k * sample rate / window size.
+    void dumpPSD()
+    {
+        std::string filename = "dump_at_" + std::to_string(getApp().getTime()) + ".psd";
+        FILE *datFile = fopen(filename.c_str(), "wb");
+
+        if (!datFile)
+        {
+            std::cout << "Datfile not open at '" << filename << "'" << std::endl;
+        }
+        else
+        {
+            withViewColumns([&](auto& cols_l, auto& cols_r) { dumpPSD(datFile, cols_l, cols_r); });
+            fclose(datFile);
+        }
+    }
+
+    template <typename T>
+    void dumpPSD(FILE* datFile, const Columns<T>& cols_l, const Columns<T>& cols_r)
+    {
+        const uint32_t version = 1;
+        const double sampleRate = cols_l.sampleRate;
+        const uint64_t frames = cols_l.welch.frames;
+        const double enbw = cols_l.welch.enbw();
+        const uint32_t channels = 2;
+        cols_l.welch.query(psd_l, cols_l.sampleRate, cols_l.fct);
+        cols_r.welch.query(psd_r, cols_r.sampleRate, cols_r.fct);
+        const uint32_t bins = psd_l.size();
+
+        fwrite("WPSD", 1, 4, datFile);
+        fwrite(&version, sizeof(version), 1, datFile);
+        fwrite(&sampleRate, sizeof(sampleRate), 1, datFile);
+        fwrite(&cols_l.window_size, sizeof(cols_l.window_size), 1, datFile);
+        fwrite(&cols_l.hop_size, sizeof(cols_l.hop_size), 1, datFile);
+        fwrite(&frames, sizeof(frames), 1, datFile);
+        fwrite(&enbw, sizeof(enbw), 1, datFile);
+        fwrite(&bins, sizeof(bins), 1, datFile);
+        fwrite(&channels, sizeof(channels), 1, datFile);
+        fwrite(psd_l.data(), sizeof(double), bins, datFile);
+        fwrite(psd_r.data(), sizeof(double), bins, datFile);
+    }
+
+    // Binary partial dump, little endian:
+    //   char[4] "PART", uint32 version (1), float64 sample rate, float64 seconds per column,
+    //   uint32 tracks, then per track uint32 first column, uint32 points and float32 Hz, float32 dB
+    //   for every point, one per column from the first one on.
+    // Column 0 is the oldest one kept, tracks with a single point are left out.
+    void dumpPartials()
+    {
+        std::string filename = "dump_at_" + std::to_string(getApp().getTime()) + ".partials";
+        FILE *datFile = fopen(filename.c_str(), "wb");
+
+        if (!datFile)
+        {
+            std::cout << "Datfile not open at '" << filename << "'" << std::endl;
+        }
+        else
+        {
+            const uint32_t version = 1;
+            const double sampleRate = getSampleRate();
+            const double seconds_per_column = columns_l.secondsPerColumn();
+            uint32_t tracks = 0;
+            partials.forEachTrack(2, [&](size_t, const PartialTracker::Point*, size_t) { tracks++; });
+            fwrite("PART", 1, 4, datFile);
+            fwrite(&version, sizeof(version), 1, datFile);
+            fwrite(&sampleRate, sizeof(sampleRate), 1, datFile);
+            fwrite(&seconds_per_column, sizeof(seconds_per_column), 1, datFile);
+            fwrite(&tracks, sizeof(tracks), 1, datFile);
+            partials.forEachTrack(2, [&](size_t column, const PartialTracker::Point* points, size_t count) {
+                const uint32_t first = column, n = count;
+                fwrite(&first, sizeof(first), 1, datFile);
+                fwrite(&n, sizeof(n), 1, datFile);
+                for (size_t i = 0; i < count; i++) {
+                    fwrite(&points[i].frequency, sizeof(float), 1, datFile);
+                    fwrite(&points[i].db, sizeof(float), 1, datFile);
+                }
+            });
             fclose(datFile);
         }
     }
@@ -589,12 +1429,25 @@ protected:
             // else dumpToCSV();
             return true;
         }
+        if (texture_rect.contains(ev.pos) && ev.button == 2 && ev.press == true && (ev.mod & DGL_NAMESPACE::kModifierShift))
+        {
+            // pin the frequency under the mouse for the tracker, oldest pin goes first when full
+            int bin = botbin + static_cast<int>(std::floor((texture_h - (ev.pos.getY() - texture_rect.getY())) / (texture_h / static_cast<float>(topbin - botbin))));
+            if (pinned_frequencies.size() >= SlidingDFT::max_tracks - 1)
+                pinned_frequencies.erase(pinned_frequencies.begin());
+            pinned_frequencies.push_back(freqAtBin(bin));
+            updateTrackerFrequencies();
+            repaint();
+            return true;
+        }
         if (texture_rect.contains(ev.pos) && ev.button == 2 && ev.press == true)
         {
             cursor2_moving = true;
+            cursor2_placed = true;
             cursor2.setY(ev.pos.getY() - texture_rect.getY());
             cursor2_bin = botbin + static_cast<int>(std::floor((texture_h - cursor2.getY()) / (texture_h / static_cast<float>(topbin - botbin))));
             updateBinAtCursor();
+            updateTrackerFrequencies();
             repaint();
         }
         if (ev.button == 2 && ev.press == false) cursor2_moving = false;
@@ -632,24 +1485,104 @@ protected:
             peakButton.setBackgroundColor(peakBinsOnly ? Color(96, 96, 96) : Color(32, 32, 32));
             request_raster_all = true;
         }
-        repaint();
-    }
-
-    void knobDragStarted(SubWidget* const widget) override
-    {
-        // editParameter(widget->getId(), true);*
-        // d_stdout("knobDragStarted");
-    }
-
-    void knobDragFinished(SubWidget* const widget) override
-    {
+        if (widget == &multiresButton)
+        {
+            bool enabled = !columns_l.multi_resolution;
+            changeEngines([&](auto& cols) { cols.setMultiResolution(enabled); });
+            multiresButton.setBackgroundColor(columns_l.multi_resolution ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &trackerButton)
+        {
+            tracking = !tracking;
+            if (!tracking) pinned_frequencies.clear();
+            updateTrackerFrequencies();
+            trackerButton.setBackgroundColor(tracking ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &precisionButton)
+        {
+            precise = !precise;
+            requested_analysis = true;
+            precisionButton.setBackgroundColor(precise ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &dbButton)
+        {
+            decibels = !decibels;
+            dbButton.setBackgroundColor(decibels ? Color(96, 96, 96) : Color(32, 32, 32));
+            request_raster_all = true;
+        }
+        if (widget == &smoothButton)
+        {
+            smooth = !smooth;
+            smoothButton.setBackgroundColor(smooth ? Color(96, 96, 96) : Color(32, 32, 32));
+            updateTraceSettings();
+        }
+        if (widget == &psdButton)
+        {
+            // Welch wants overlapping frames, the view runs at half window hop while measuring
+            welching = !welching;
+            changeEngines([&](auto& cols) { cols.psd = welching; });
+            psdButton.setBackgroundColor(welching ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &exportButton)
+        {
+            dumpPSD();
+        }
+        if (widget == &exportPartialsButton)
+        {
+            dumpPartials();
+        }
+        if (widget == &alignButton)
+        {
+            aligning = !aligning;
+            delay_estimator.reset();
+            std::snprintf(align_text, sizeof(align_text), "%s", channels.identity ? "..." : "L / R only");
+            updateMeasurementSettings();
+            alignButton.setBackgroundColor(aligning ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &pitchButton)
+        {
+            pitching = !pitching;
+            pitchButton.setBackgroundColor(pitching ? Color(96, 96, 96) : Color(32, 32, 32));
+        }
+        if (widget == &resetButton)
+        {
+            // goes through the plugin so the reset lands on a block boundary
+            setState("reset", "");
+        }
+        repaint();
+    }
+
+    void knobDragStarted(SubWidget* const widget) override
+    {
+        // editParameter(widget->getId(), true);*
+        // d_stdout("knobDragStarted");
+    }
+
+    void knobDragFinished(SubWidget* const widget) override
+    {
         // d_stdout("knobDragFinished");
         // editParameter(widget->getId(), false);
     }
 
+    int binCount()
+    {
+        return columns_l.outputSize();
+    }
+
     float freqAtBin(int bin)
     {
-        return bin * (getSampleRate() / (window_size / 2 + 1) / 2 );
+        return columns_l.frequencyAt(std::min(bin, binCount() - 1));
+    }
+
+    // Frequency of a bin, or in cepstrum mode its quefrency and the frequency of that period
+    void binLabel(char* dest, size_t size, int bin)
+    {
+        if (columns_l.cepstral) {
+            const int q = std::min(bin, binCount() - 1);
+            std::snprintf(dest, size, "%.3fms %.1fHz", columns_l.quefrencyAt(q) * 1000, freqAtBin(q));
+        } else {
+            std::snprintf(dest, size, "%3.3fHz", freqAtBin(bin));
+        }
     }
 
     void knobValueChanged(SubWidget* const widget, float value) override
@@ -657,23 +1590,92 @@ protected:
         auto w = static_cast<DragFloat*>(widget);
         if (w == dragfloat_multiplier) {
             multiplier = value;
+            gain_db = 20 * std::log10(multiplier);
+        }
+        if (w == dragfloat_average || w == dragfloat_frames || w == dragfloat_decay) {
+            updateTraceSettings();
+            updateMeasurementSettings();
+        }
+        if (w == dragfloat_channels || w == dragfloat_matrix[0] || w == dragfloat_matrix[1]
+            || w == dragfloat_matrix[2] || w == dragfloat_matrix[3]) {
+            // workers read the matrix for every frame
+            pool.cancel();
+            updateChannelMatrix();
+            requested_analysis = true;
+        }
+        if (w == dragfloat_descriptor) {
+            // columns analysed without descriptors get them from the history
+            const bool enabled = descriptorKind() != kDescriptorOff;
+            if (enabled != columns_l.describing) {
+                changeEngines([&](auto& cols) { cols.describing = enabled; });
+            }
+        }
+        if (w == dragfloat_overlay) {
+            const bool harmonics = overlayMode() == kOverlayHarmonics;
+            if (harmonics != columns_l.harmonics) {
+                changeEngines([&](auto& cols) { cols.harmonics = harmonics; });
+            }
+            if (overlayMode() == kOverlayOnsets) resetOnsets();
+            if (overlayMode() == kOverlayPartials) resetPartials();
+            exportPartialsButton.setVisible(overlayMode() != kOverlayLPC);
+            dragfloat_lpc_order->setVisible(overlayMode() == kOverlayLPC);
+            updateLPCSettings();
+            request_raster_all = true;
+        }
+        if (w == dragfloat_lpc_order) {
+            updateLPCSettings();
+        }
+        if (w == dragfloat_transfer) {
+            updateMeasurementSettings();
+            request_raster_all = true;
+        }
+        if (w == dragfloat_floor || w == dragfloat_ceiling) {
+            db_floor = std::min(dragfloat_floor->getValue(), dragfloat_ceiling->getValue() - 1);
+            db_ceiling = dragfloat_ceiling->getValue();
+            request_raster_all = true;
+            if (noiseFloorMode() == kFloorNormalize) {
+                changeEngines([&](auto& cols) { cols.floor_reference_db = db_floor; });
+            }
         }
         if (w == dragfloat_topbin) {
-            topbin = std::min(float(window_size / 2 + 1), value);
+            topbin = std::min(float(binCount()), value);
             topbin = std::max(botbin, topbin);
-            std::sprintf(topbin_text, "%3.3fHz", freqAtBin(topbin == window_size / 2 + 1 ? topbin - 1 : topbin));
+            binLabel(topbin_text, sizeof(topbin_text), topbin == binCount() ? topbin - 1 : topbin);
             w->setValue(topbin);
             request_raster_all = true;
         }
         if (w == dragfloat_botbin) {
-            botbin = std::min(float(window_size / 2 + 1), value);
+            botbin = std::min(float(binCount()), value);
             botbin = std::min(botbin, topbin);
-            std::sprintf(botbin_text, "%3.3fHz", freqAtBin(botbin == 0 ? 1 : botbin));
+            binLabel(botbin_text, sizeof(botbin_text), botbin == 0 ? 1 : botbin);
             w->setValue(botbin);
             request_raster_all = true;
         }
         if (w == dragfloat_windowsize) {
-            requested_window_size = to_window_size_po2(value);
+            requested_window_size = dragfloat_windowsize->presets[static_cast<int>(value)].length;
+            dragfloat_length->setValue(requested_window_size, false);
+        }
+        if (w == dragfloat_length) {
+            requested_window_size = static_cast<int>(value);
+            dragfloat_windowsize->setValue(presetForLength(requested_window_size), false);
+        }
+        if (w == dragfloat_analysis) {
+            // zoom into the band currently selected with the top and bottom bins
+            if (static_cast<int>(value) == kAnalysisZoom && !columns_l.zoomed) {
+                // quefrency bins select no band, zoom into the whole spectrum then
+                zoom_lo = columns_l.cepstral ? 0.0f : freqAtBin(botbin);
+                zoom_hi = columns_l.cepstral ? getSampleRate() / 2 : freqAtBin(topbin);
+            }
+            requested_analysis = true;
+        }
+        if (w == dragfloat_bands && (columns_l.filterbank || columns_l.scalogram)) {
+            requested_analysis = true;
+        }
+        if (w == dragfloat_lifter && columns_l.cepstral) {
+            requested_analysis = true;
+        }
+        if (w == dragfloat_nw && columns_l.multitaper) {
+            requested_analysis = true;
         }
         if (w == dragfloat_delay) {
             auto v = static_cast<int>(value);
@@ -685,6 +1687,12 @@ protected:
                 buffer_r.sampleOffset = v - 4096;
             }
         }
+        if (w == dragfloat_noise_floor) {
+            setNoiseFloorMode(static_cast<FloorMode>(static_cast<int>(value)));
+        }
+        if (w == dragfloat_threshold && noiseFloorMode() == kFloorGate) {
+            changeEngines([&](auto& cols) { cols.floor_above_db = value; });
+        }
         if (frozen && (w == dragfloat_multiplier || w == dragfloat_threshold))
         {
             request_raster_all = true;
@@ -703,31 +1711,863 @@ protected:
         }
     }
 
-    static int to_window_size_po2(float value) { return static_cast<int>(std::pow(2, 7 + static_cast<int>(value))); }
-    static int from_window_size_po2(int value) { return std::log2(value) - 7; }
+    // Powers of two from 128 to 16384 merged with common analysis durations at the current rate,
+    // any other length can be typed in the Length control
+    void initWindowPresets()
+    {
+        auto& presets = dragfloat_windowsize->presets;
+        presets.clear();
+        for (int n = 128; n <= 16384; n *= 2)
+            presets.push_back({n, 0.0f});
+        for (float ms : {5.0f, 10.0f, 20.0f, 40.0f, 50.0f, 100.0f, 200.0f}) {
+            int n = std::lround(ms * getSampleRate() / 1000);
+            if (n >= min_window_size && n <= max_window_size)
+                presets.push_back({n, ms});
+        }
+        std::stable_sort(presets.begin(), presets.end(), [](const WindowPreset& a, const WindowPreset& b) {
+            return a.length < b.length;
+        });
+    }
+
+    // Nearest preset, used to keep the preset control in sync with typed lengths
+    int presetForLength(int length)
+    {
+        auto& presets = dragfloat_windowsize->presets;
+        int best = 0;
+        for (int k = 1; k < static_cast<int>(presets.size()); k++) {
+            if (std::abs(presets[k].length - length) < std::abs(presets[best].length - length))
+                best = k;
+        }
+        return best;
+    }
 
     // -------------------------------------------------------------------------------------------------------
 
 private:
     Spectrogram* plugin_ptr;
-    Columns columns_l;
+    Columns<float> columns_l;
     Color color_l = Color(255,0,0,1);
-    Columns columns_r;
+    Columns<float> columns_r;
     Color color_r = Color(0,0,255,1);
 
+    // Double precision engines, fed and rastered instead of the float ones when precise is set
+    Columns<double> precise_l;
+    Columns<double> precise_r;
+    std::vector<double> precise_input;
+    bool precise = false;
+    Button precisionButton;
+
+    template <typename F>
+    void withColumns(F&& f)
+    {
+        if (precise) f(precise_l, precise_r);
+        else f(columns_l, columns_r);
+    }
+
+    // Settings are kept identical on all engines
+    template <typename F>
+    void forEachColumns(F&& f)
+    {
+        f(columns_l);
+        f(columns_r);
+        f(precise_l);
+        f(precise_r);
+    }
+
+    // Settings the workers read change with none of them running, the history is then analysed
+    // again with the new ones
+    template <typename F>
+    void changeEngines(F&& f)
+    {
+        pool.cancel();
+        forEachColumns(f);
+        requested_analysis = true;
+    }
+
+    template <typename T>
+    const std::vector<T>* windowFor(Columns<T>&) { return &cached_hann<T>(window_size); }
+
+    int feedColumns(Columns<float>& cols, float* data, size_t length)
+    {
+        return cols.feed(data, length);
+    }
+
+    int feedColumns(Columns<double>& cols, float* data, size_t length)
+    {
+        precise_input.assign(data, data + length);
+        return cols.feed(precise_input.data(), length);
+    }
+
+    // Matrixed channels in, the second engine is left alone for single channel modes
+    template <typename T>
+    int feedChannels(Columns<T>& cols_l, Columns<T>& cols_r, float* first, float* second, size_t length)
+    {
+        int n = feedColumns(cols_l, first, length);
+        if (!channels.single) feedColumns(cols_r, second, length);
+        if (overlayMode() == kOverlayOnsets) detectOnsets(cols_l, cols_r, n);
+        if (overlayMode() == kOverlayPartials) trackPartials(cols_l, n);
+        return n;
+    }
+
+    // Engines the view reads: the first one alone for single channel modes, the measurement
+    // channel alone while Transfer is on, both otherwise
+    template <typename F>
+    void withViewColumns(F&& f)
+    {
+        withColumns([&](auto& cols_l, auto& cols_r) {
+            if (channels.single) f(cols_l, cols_l);
+            else if (transferMode() != kTransferOff) f(cols_r, cols_r);
+            else f(cols_l, cols_r);
+        });
+    }
+
+    // Channels analysed, L / R goes straight to the engines, anything else through the matrix.
+    // History keeps L / R so changing the matrix re-analyses it.
+    ChannelMatrix channels;
+    std::vector<float> matrixed_first;
+    std::vector<float> matrixed_second;
+
+    void updateChannelMatrix()
+    {
+        const auto mode = static_cast<ChannelMode>(static_cast<int>(dragfloat_channels->getValue()));
+        float custom[4];
+        for (int k = 0; k < 4; k++) {
+            custom[k] = dragfloat_matrix[k]->getValue();
+            dragfloat_matrix[k]->setVisible(mode == kChannelsMatrix);
+        }
+        channels.set(mode, custom);
+    }
+
+    void matrixChannels(const float* l, const float* r, size_t length)
+    {
+        matrixed_first.resize(length);
+        matrixed_second.resize(length);
+        channels.apply(l, r, matrixed_first.data(), matrixed_second.data(), length);
+    }
+
+    size_t columnsCount()
+    {
+        return precise ? precise_l.columns.size() : columns_l.columns.size();
+    }
+
     int botbin;
     int topbin;
 
     float multiplier = 1.0;
 
+    // Averages and holds, shown as an overlay on the right of the spectrogram and
+    // rastered instead of the raw bins when smooth is set
+    Button smoothButton;
+    Button resetButton;
+    bool smooth = false;
+
+    TraceMode traceMode()
+    {
+        return static_cast<TraceMode>(static_cast<int>(dragfloat_average->getValue()));
+    }
+
+    void updateTraceSettings()
+    {
+        TraceMode mode = traceMode();
+        forEachColumns([&](auto& cols) {
+            cols.averaging = mode != kTraceOff;
+            cols.smoothing = smooth ? mode : kTraceOff;
+            cols.traces.setFrames(static_cast<uint32_t>(dragfloat_frames->getValue()));
+            cols.hold_decay_db = dragfloat_decay->getValue();
+        });
+    }
+
+    template <typename T>
+    void drawTraceOverlay(const Columns<T>& cols_l, const Columns<T>& cols_r, float x, float y)
+    {
+        const auto* trace_l = cols_l.traces.trace(traceMode());
+        const auto* trace_r = cols_r.traces.trace(traceMode());
+        if (!trace_l || !trace_r || trace_l->size() != static_cast<size_t>(binCount()) || trace_r->size() != trace_l->size())
+            return;
+
+        float at = botbin;
+        float step = (topbin - at) / texture_h;
+        beginPath();
+        for (int i = 0; i < texture_h; i++) {
+            float v = std::max(interpolate(at, *trace_l, trace_l->size()), interpolate(at, *trace_r, trace_r->size()));
+            float px = x + texture_w - withGain(levelOf(v)) * overlay_w;
+            float py = y + texture_h - 1 - i;
+            if (i == 0) moveTo(px, py);
+            else lineTo(px, py);
+            at += step;
+        }
+        strokeColor(Color(255, 255, 255, 192));
+        strokeWidth(1.0f);
+        stroke();
+    }
+
+    // Welch PSD, queried on every repaint while the live view keeps running
+    Button psdButton;
+    Button exportButton;
+    bool welching = false;
+    std::vector<double> psd_l;
+    std::vector<double> psd_r;
+    char psd_text[64];
+
+    int hopSize()
+    {
+        return welching ? window_size / 2 : window_size;
+    }
+
+    template <typename T>
+    void drawPSDOverlay(const Columns<T>& cols_l, const Columns<T>& cols_r, float x, float y)
+    {
+        cols_l.welch.query(psd_l, cols_l.sampleRate, cols_l.fct);
+        cols_r.welch.query(psd_r, cols_r.sampleRate, cols_r.fct);
+
+        fillColor(Color(1.f, 1.f, 1.f));
+        std::snprintf(psd_text, sizeof(psd_text), "PSD: %llu frames, %.1fs", static_cast<unsigned long long>(cols_l.welch.frames),
+                      cols_l.welch.seconds(cols_l.sampleRate, cols_l.hop_size));
+        text(x + texture_w - overlay_w, y + 20, psd_text, nullptr);
+
+        if (cols_l.welch.frames == 0 || psd_l.size() != static_cast<size_t>(binCount()))
+            return;
+
+        // dBFS/Hz against the dB floor and ceiling whatever the display mode
+        float at = botbin;
+        float step = (topbin - at) / texture_h;
+        beginPath();
+        for (int i = 0; i < texture_h; i++) {
+            float v = std::max(interpolate(at, psd_l, psd_l.size()), interpolate(at, psd_r, psd_r.size()));
+            float level = std::clamp((v - db_floor) / (db_ceiling - db_floor), 0.0f, 1.0f);
+            float px = x + texture_w - level * overlay_w;
+            float py = y + texture_h - 1 - i;
+            if (i == 0) moveTo(px, py);
+            else lineTo(px, py);
+            at += step;
+        }
+        strokeColor(Color(255, 160, 0, 192));
+        strokeWidth(1.0f);
+        stroke();
+    }
+
+    // Transfer function of the right channel against the left one as reference. Spectra of
+    // both engines are paired frame by frame, the averaging follows Average: exponential over
+    // Frames in Exp mode, everything since Reset otherwise.
+    TransferFunction transfer;
+    std::vector<double> transfer_mag;
+    std::vector<double> transfer_phase;
+    std::vector<double> transfer_coherence;
+    char transfer_text[64];
+    // magnitude range of the overlay, centered on 0dB
+    static constexpr float transfer_range_db = 30.0f;
+
+    TransferEstimator transferMode()
+    {
+        return static_cast<TransferEstimator>(static_cast<int>(dragfloat_transfer->getValue()));
+    }
+
+    // Engines keep their spectra while either two channel measurement runs
+    void updateMeasurementSettings()
+    {
+        const bool on = transferMode() != kTransferOff || aligning;
+        forEachColumns([&](auto& cols) {
+            cols.keep_spectra = on;
+            cols.spectra.clear();
+        });
+        transfer.setFrames(traceMode() == kTraceExponential ? static_cast<uint32_t>(dragfloat_frames->getValue()) : 0);
+        if (transfer.size() != static_cast<size_t>(window_size / 2 + 1))
+            transfer.init(window_size / 2 + 1);
+        if (delay_estimator.window_size != static_cast<uint32_t>(window_size))
+            delay_estimator.init(window_size);
+        delay_estimator.setFrames(4 * align_frames);
+    }
+
+    // Pairs the spectra of the n frames just fed. With Transfer on, the bins of the matching
+    // measurement columns are weighted with the coherence at that point, which keeps the raw
+    // bins while the channels are correlated and fades out what the reference doesn't explain.
+    template <typename T>
+    void measureSpectra(Columns<T>& cols_l, Columns<T>& cols_r, int n)
+    {
+        const size_t bins = cols_l.window_size / 2 + 1;
+        if (cols_l.spectra.size() != cols_r.spectra.size() || cols_l.spectra.size() != n * bins) {
+            cols_l.spectra.clear();
+            cols_r.spectra.clear();
+            return;
+        }
+        const bool measuring = transferMode() != kTransferOff && transfer.size() == bins;
+        const bool estimating = aligning && channels.identity && delay_estimator.size() == bins;
+        for (int i = 0; i < n; i++) {
+            const auto* x = cols_l.spectra.data() + i * bins;
+            const auto* y = cols_r.spectra.data() + i * bins;
+            if (estimating) delay_estimator.accumulate(x, y);
+            if (!measuring) continue;
+            transfer.accumulate(x, y);
+            auto& col = cols_r.columns[cols_r.columns.size() - n + i];
+            if (col.size != bins) continue;
+            for (size_t k = 0; k < bins; k++) col.bins[k] *= transfer.coherence(k);
+            cols_r.finishColumn(col);
+        }
+        cols_l.spectra.clear();
+        cols_r.spectra.clear();
+        if (estimating && n > 0) updateAlignment();
+    }
+
+    // Auto align: GCC-PHAT between L and R on the analysis frames, the whole sample part of a
+    // confident estimate goes to the Delay control and the estimate starts over from there
+    Button alignButton;
+    bool aligning = false;
+    DelayEstimator delay_estimator;
+    double align_delay = 0.0;
+    double align_confidence = 0.0;
+    char align_text[32];
+    static constexpr uint64_t align_frames = 16;
+    static constexpr double align_min_confidence = 0.2;
+
+    void updateAlignment()
+    {
+        if (!delay_estimator.estimate(align_delay, align_confidence)) return;
+        std::snprintf(align_text, sizeof(align_text), "%+.2f (%.2f)", align_delay, align_confidence);
+        if (delay_estimator.frames < align_frames || align_confidence < align_min_confidence) return;
+
+        // the lag left after the current offsets, positive when R comes late: L gets delayed
+        const int whole = static_cast<int>(std::lround(align_delay));
+        if (whole == 0) return;
+        dragfloat_delay->setValue(std::clamp(dragfloat_delay->getValue() - whole, 0.0f, 8192.0f), true);
+        delay_estimator.reset();
+    }
+
+    // Magnitude in green over +-transfer_range_db, phase in blue over +-pi and coherence in
+    // white over 0..1, on the same bins as the spectrogram
+    void drawTransferOverlay(float x, float y)
+    {
+        const TransferEstimator mode = transferMode();
+        transfer.query(mode, transfer_mag, transfer_phase, transfer_coherence);
+
+        fillColor(Color(1.f, 1.f, 1.f));
+        std::snprintf(transfer_text, sizeof(transfer_text), "%s: %llu frames", mode == kTransferH2 ? "H2" : "H1",
+                      static_cast<unsigned long long>(transfer.frames));
+        text(x + texture_w - overlay_w, y + 40, transfer_text, nullptr);
+
+        if (transfer.frames == 0 || transfer_mag.size() != static_cast<size_t>(binCount()))
+            return;
+
+        auto curve = [&](const std::vector<double>& values, float lo, float hi, Color color) {
+            float at = botbin;
+            float step = (topbin - at) / texture_h;
+            beginPath();
+            for (int i = 0; i < texture_h; i++) {
+                float level = std::clamp((interpolate(at, values, values.size()) - lo) / (hi - lo), 0.0f, 1.0f);
+                float px = x + texture_w - level * overlay_w;
+                float py = y + texture_h - 1 - i;
+                if (i == 0) moveTo(px, py);
+                else lineTo(px, py);
+                at += step;
+            }
+            strokeColor(color);
+            strokeWidth(1.0f);
+            stroke();
+        };
+        curve(transfer_coherence, 0.0f, 1.0f, Color(255, 255, 255, 128));
+        curve(transfer_phase, -M_PI, M_PI, Color(64, 160, 255, 192));
+        curve(transfer_mag, -transfer_range_db, transfer_range_db, Color(64, 255, 128, 224));
+    }
+
+    // Spectral descriptors drawn across the view, one point per column: frequencies on the
+    // spectrogram's own axis, flatness and entropy over the full height, crest in dB up to
+    // crest_range_db and flux against its largest visible value
+    static constexpr float crest_range_db = 60.0f;
+
+    DescriptorKind descriptorKind()
+    {
+        return static_cast<DescriptorKind>(static_cast<int>(dragfloat_descriptor->getValue()));
+    }
+
+    // Inverse of freqAtBin, fractional
+    float binAtFrequency(float f)
+    {
+        const size_t n = binCount();
+        // a period of sampleRate / f samples
+        if (columns_l.cepstral) {
+            return f > 0.0f ? std::clamp(static_cast<float>(getSampleRate()) / f, 0.0f, static_cast<float>(n - 1)) : 0.0f;
+        }
+        if (const std::vector<float>* bin_centers = columns_l.centerFrequencies()) {
+            const auto& centers = *bin_centers;
+            auto it = std::lower_bound(centers.begin(), centers.end(), f);
+            if (it == centers.begin()) return 0.0f;
+            if (it == centers.end()) return n - 1;
+            size_t k = it - centers.begin();
+            return k - 1 + (f - centers[k - 1]) / (centers[k] - centers[k - 1]);
+        }
+        const float f0 = columns_l.frequencyAt(0);
+        const float df = columns_l.frequencyAt(1) - f0;
+        return df > 0.0f ? std::clamp((f - f0) / df, 0.0f, static_cast<float>(n - 1)) : 0.0f;
+    }
+
+    template <typename T>
+    void drawDescriptorCurves(const Columns<T>& cols_l, const Columns<T>& cols_r, float x, float y)
+    {
+        const DescriptorKind kind = descriptorKind();
+        const bool frequency = kind >= kDescriptorCentroid && kind <= kDescriptorRolloff95;
+        auto columns_size = cols_l.columns.size();
+        int start_col = columns_size < n_columns ? n_columns - columns_size : 0;
+        int end_col = columns_size < n_columns ? columns_size : n_columns;
+        size_t first = columns_size < n_columns ? 0 : columns_size - n_columns;
+
+        float flux_max = 1e-20f;
+        if (kind == kDescriptorFlux) {
+            for (int i = 0; i < end_col; i++) {
+                flux_max = std::max({ flux_max, cols_l.columns[first + i].descriptors.flux, cols_r.columns[first + i].descriptors.flux });
+            }
+        }
+
+        auto level = [&](float v) {
+            if (frequency) return (binAtFrequency(v) - botbin) / std::max(1, topbin - botbin);
+            if (kind == kDescriptorCrest) return 20 * std::log10(std::max(v, 1.0f)) / crest_range_db;
+            if (kind == kDescriptorFlux) return v / flux_max;
+            return v;
+        };
+
+        const bool both = &cols_l != &cols_r;
+        for (const auto* cols : { &cols_l, &cols_r }) {
+            if (cols == &cols_r && !both) break;
+            beginPath();
+            bool drawing = false;
+            for (int i = 0; i < end_col; i++) {
+                const auto& col = cols->columns[first + i];
+                if (!col.processed) {
+                    drawing = false;
+                    continue;
+                }
+                float px = x + (i + start_col) * column_w + column_w / 2.0f;
+                float py = y + texture_h - 1 - std::clamp(level(descriptorValue(col.descriptors, kind)), 0.0f, 1.0f) * (texture_h - 1);
+                if (!drawing) moveTo(px, py);
+                else lineTo(px, py);
+                drawing = true;
+            }
+            strokeColor(cols == &cols_l && both ? Color(255, 112, 112, 224) : Color(112, 176, 255, 224));
+            strokeWidth(1.5f);
+            stroke();
+        }
+    }
+
+    // Pitch from the plugin's tracker, one point per message at the history position it ended on.
+    // Columns look theirs up by counting hops back from the end of the history, so the curve
+    // stays put across re-analysis.
+    struct PitchPoint {
+        uint64_t end;
+        float frequency;
+        float clarity;
+    };
+    Button pitchButton;
+    bool pitching = false;
+    std::deque<PitchPoint> pitch_track;
+    char pitch_text[48];
+
+    void updatePitchText()
+    {
+        if (pitch_track.empty() || pitch_track.back().frequency <= 0.0f) {
+            std::snprintf(pitch_text, sizeof(pitch_text), "f0 ---\nclarity %.2f", pitch_track.empty() ? 0.0f : pitch_track.back().clarity);
+            return;
+        }
+        const auto& p = pitch_track.back();
+        const int note = static_cast<int>(fton(p.frequency));
+        std::snprintf(pitch_text, sizeof(pitch_text), "f0 %.1fHz %s%d\nclarity %.2f",
+                      p.frequency, names[note % 12], note / 12 - 1, p.clarity);
+    }
+
+    template <typename T>
+    void drawPitchCurve(const Columns<T>& cols, float x, float y)
+    {
+        if (pitch_track.empty()) return;
+        auto columns_size = cols.columns.size();
+        int start_col = columns_size < n_columns ? n_columns - columns_size : 0;
+        int end_col = columns_size < n_columns ? columns_size : n_columns;
+        size_t first = columns_size < n_columns ? 0 : columns_size - n_columns;
+        const double hop = cols.secondsPerColumn() * cols.sampleRate;
+
+        beginPath();
+        bool drawing = false;
+        for (int i = 0; i < end_col; i++) {
+            const uint64_t back = static_cast<uint64_t>((columns_size - 1 - (first + i)) * hop);
+            auto it = back <= history_l.end()
+                ? std::upper_bound(pitch_track.begin(), pitch_track.end(), history_l.end() - back,
+                                   [](uint64_t pos, const PitchPoint& p) { return pos < p.end; })
+                : pitch_track.begin();
+            if (it == pitch_track.begin() || std::prev(it)->frequency <= 0.0f) {
+                drawing = false;
+                continue;
+            }
+            float px = x + (i + start_col) * column_w + column_w / 2.0f;
+            float level = (binAtFrequency(std::prev(it)->frequency) - botbin) / std::max(1, topbin - botbin);
+            float py = y + texture_h - 1 - std::clamp(level, 0.0f, 1.0f) * (texture_h - 1);
+            if (!drawing) moveTo(px, py);
+            else lineTo(px, py);
+            drawing = true;
+        }
+        strokeColor(Color(255, 224, 64, 224));
+        strokeWidth(2.0f);
+        stroke();
+    }
+
+    // Harmonic sum: columns with a salient series get it marked when rastered, the newest
+    // column's f0 is written over the view
+    static constexpr float harmonic_min_salience_db = 15.0f;
+    char harmonic_text[64];
+
+    OverlayMode overlayMode()
+    {
+        return static_cast<OverlayMode>(static_cast<int>(dragfloat_overlay->getValue()));
+    }
+
+    template <typename T>
+    void drawHarmonicText(const Columns<T>& cols, float x, float y)
+    {
+        if (cols.columns.empty()) return;
+        const HarmonicSeries& hs = cols.columns.back().harmonic;
+        if (cols.filterbank || cols.zoomed || cols.cepstral || cols.scalogram) {
+            std::snprintf(harmonic_text, sizeof(harmonic_text), "Harmonics: STFT only");
+        } else if (hs.f0 <= 0.0f || hs.salience < harmonic_min_salience_db) {
+            std::snprintf(harmonic_text, sizeof(harmonic_text), "Harmonics: ---");
+        } else {
+            const int note = static_cast<int>(fton(hs.f0));
+            std::snprintf(harmonic_text, sizeof(harmonic_text), "Harmonics: f0 %.1fHz %s%d (%.0fdB)",
+                          hs.f0, names[note % 12], note / 12 - 1, hs.salience);
+        }
+        fillColor(Color(1.f, 1.f, 1.f));
+        text(x + texture_w - overlay_w, y + 60, harmonic_text, nullptr);
+    }
+
+    // Onsets: log spectral flux of every column fed, averaged over both engines, through a peak
+    // picker, each onset then placed on the samples of its frame in the history. The same flux
+    // feeds the tempo estimate. Onsets are absolute history positions, drawn as markers.
+    static constexpr float onset_floor_db = -100.0f;
+    static constexpr size_t onset_block = 64;
+    OnsetDetector onset_detector;
+    TempoEstimator tempo;
+    std::deque<uint64_t> onsets;
+    std::vector<float> onset_frame;
+    std::vector<float> onset_frame_r;
+    char tempo_text[64];
+
+    void resetOnsets()
+    {
+        const float cps = 1.0f / columns_l.secondsPerColumn();
+        onset_detector.init(std::max(1, static_cast<int>(0.03f * cps)), static_cast<int>(0.1f * cps));
+        tempo.init(cps, 8.0f);
+        onsets.clear();
+    }
+
+    template <typename T>
+    void detectOnsets(const Columns<T>& cols_l, const Columns<T>& cols_r, int n)
+    {
+        // the zoom's and the scalogram's frames don't line up with the history
+        if (cols_l.zoomed || cols_l.scalogram) return;
+        const size_t size = cols_l.columns.size();
+        const bool both = !channels.single && cols_r.columns.size() == size;
+        const uint64_t hop = cols_l.hop_size;
+        for (int i = 0; i < n; i++) {
+            const size_t c = size - n + i;
+            if (c == 0 || cols_l.columns[c - 1].size != cols_l.columns[c].size) continue;
+            float odf = log_flux(cols_l.columns[c].bins_db.data(), cols_l.columns[c - 1].bins_db.data(), cols_l.columns[c].size, onset_floor_db);
+            if (both) {
+                odf += log_flux(cols_r.columns[c].bins_db.data(), cols_r.columns[c - 1].bins_db.data(), cols_r.columns[c].size, onset_floor_db);
+                odf *= 0.5f;
+            }
+            tempo.push(odf);
+            uint64_t onset;
+            if (!onset_detector.push(odf, onset)) continue;
+
+            // frame of the onset column and a hop either side
+            const uint64_t back = cols_l.pendingSamples() + (n - 1 - i + onset_detector.pushed - 1 - onset) * hop + cols_l.window_size;
+            if (back + hop > history_l.end()) continue;
+            const uint64_t lo = std::max(history_l.begin(), history_l.end() - back - hop);
+            const uint64_t hi = std::min(history_l.end(), history_l.end() - back + cols_l.window_size + hop);
+            onset_frame.resize(hi - lo);
+            onset_frame_r.resize(hi - lo);
+            history_l.read(lo, onset_frame.data(), hi - lo);
+            history_r.read(lo, onset_frame_r.data(), hi - lo);
+            for (size_t j = 0; j < onset_frame.size(); j++) onset_frame[j] += onset_frame_r[j];
+            onsets.push_back(lo + refine_onset(onset_frame.data(), onset_frame.size(), onset_block));
+        }
+        while (!onsets.empty() && onsets.front() < history_l.begin()) onsets.pop_front();
+    }
+
+    template <typename T>
+    void drawOnsets(const Columns<T>& cols, float x, float y)
+    {
+        if (cols.zoomed || cols.scalogram) {
+            std::snprintf(tempo_text, sizeof(tempo_text), "Onsets: not in zoom or wavelet");
+        } else if (tempo.bpm <= 0.0f) {
+            std::snprintf(tempo_text, sizeof(tempo_text), "Tempo: ---");
+        } else {
+            std::snprintf(tempo_text, sizeof(tempo_text), "Tempo: %.1f BPM (%.2f)", tempo.bpm, tempo.confidence);
+        }
+        fillColor(Color(1.f, 1.f, 1.f));
+        text(x + texture_w - overlay_w, y + 60, tempo_text, nullptr);
+        if (cols.zoomed || cols.scalogram || onsets.empty()) return;
+
+        // a column sits at the centre of its frame, the newest one at the right edge
+        auto columns_size = cols.columns.size();
+        const float left = x + (columns_size < n_columns ? n_columns - columns_size : 0) * column_w;
+        const float right = x + n_columns * column_w - column_w / 2.0f;
+        const double newest = static_cast<double>(history_l.end()) - cols.pendingSamples() - cols.window_size / 2.0;
+        beginPath();
+        for (uint64_t pos : onsets) {
+            const float px = right - static_cast<float>((newest - pos) / cols.hop_size) * column_w;
+            if (px < left || px > x + texture_w) continue;
+            moveTo(px, y);
+            lineTo(px, y + texture_h);
+        }
+        strokeColor(Color(255, 128, 0, 192));
+        strokeWidth(1.0f);
+        stroke();
+    }
+
+    // LPC: every column carries its all-pole model, formants are marked in the raster and the
+    // newest column's envelope is drawn over the right of the view, evaluated on the rows
+    std::vector<float> lpc_omega;
+    std::vector<float> lpc_envelope;
+    char lpc_text[96];
+
+    void updateLPCSettings()
+    {
+        const unsigned order = overlayMode() == kOverlayLPC ? static_cast<unsigned>(dragfloat_lpc_order->getValue()) : 0;
+        if (order == columns_l.lpc_order) return;
+        changeEngines([&](auto& cols) { cols.lpc_order = order; });
+    }
+
+    template <typename T>
+    void drawLPC(const Columns<T>& cols, float x, float y)
+    {
+        const LinearPrediction* lp = cols.columns.empty() ? nullptr : &cols.columns.back().lpc;
+        if (cols.cepstral || cols.zoomed || cols.scalogram) {
+            std::snprintf(lpc_text, sizeof(lpc_text), "LPC: STFT frames only");
+        } else if (!lp || lp->order == 0) {
+            std::snprintf(lpc_text, sizeof(lpc_text), "LPC: ---");
+        } else {
+            int len = std::snprintf(lpc_text, sizeof(lpc_text), "LPC %u:", lp->order);
+            for (unsigned f = 0; f < lp->n_formants && len < static_cast<int>(sizeof(lpc_text)); f++)
+                len += std::snprintf(lpc_text + len, sizeof(lpc_text) - len, " F%u %.0f", f + 1, lp->formants[f]);
+        }
+        fillColor(Color(1.f, 1.f, 1.f));
+        text(x + texture_w - overlay_w, y + 60, lpc_text, nullptr);
+        if (!lp || lp->order == 0 || cols.cepstral || cols.zoomed || cols.scalogram) return;
+
+        // frequency of every row, between the bins it falls on
+        lpc_omega.resize(texture_h);
+        lpc_envelope.resize(texture_h);
+        float at = botbin;
+        const float step = (topbin - at) / texture_h;
+        for (int i = 0; i < texture_h; i++) {
+            const int bin = std::min(static_cast<int>(at), binCount() - 2);
+            const float f = freqAtBin(bin) + (at - bin) * (freqAtBin(bin + 1) - freqAtBin(bin));
+            lpc_omega[i] = 2.0f * M_PI * f / cols.sampleRate;
+            at += step;
+        }
+        lpc_envelope_db(*lp, lpc_omega.data(), lpc_envelope.data(), texture_h);
+
+        beginPath();
+        for (int i = 0; i < texture_h; i++) {
+            const float level = withGain(levelOf(std::pow(10.0f, lpc_envelope[i] / 20.0f)));
+            const float px = x + texture_w - level * overlay_w;
+            const float py = y + texture_h - 1 - i;
+            if (i == 0) moveTo(px, py);
+            else lineTo(px, py);
+        }
+        strokeColor(Color(255, 64, 160, 192));
+        strokeWidth(1.0f);
+        stroke();
+    }
+
+    // Partials: peaks of the first engine's columns linked into tracks as they're fed, for the
+    // columns in view, drawn as lines over the spectrogram
+    static constexpr float partial_range_db = 60.0f;
+    static constexpr size_t partial_max_peaks = 256;
+    PartialTracker partials;
+    std::vector<PartialPeak> partial_peaks;
+    Button exportPartialsButton;
+    char partials_text[64];
+
+    void resetPartials()
+    {
+        partials.init(n_columns, 2.0f * (columns_l.frequencyAt(1) - columns_l.frequencyAt(0)));
+    }
+
+    template <typename T>
+    void trackPartials(const Columns<T>& cols, int n)
+    {
+        for (int i = 0; i < n; i++) {
+            const auto& col = cols.columns[cols.columns.size() - n + i];
+            find_partial_peaks(col.bins_db.data(), col.bins_peak, col.size, [&](size_t k) { return cols.frequencyAt(k); },
+                               partial_range_db, partial_max_peaks, partial_peaks);
+            partials.push(partial_peaks);
+        }
+    }
+
+    void drawPartials(float x, float y)
+    {
+        std::snprintf(partials_text, sizeof(partials_text), "Partials: %zu alive, %llu born",
+                      partials.alive(), static_cast<unsigned long long>(partials.born));
+        fillColor(Color(1.f, 1.f, 1.f));
+        text(x + texture_w - overlay_w, y + 60, partials_text, nullptr);
+
+        // the newest column tracked is the newest one in view
+        const size_t count = partials.columnCount();
+        const size_t first = count > n_columns ? count - n_columns : 0;
+        auto yAt = [&](float f) {
+            float level = (binAtFrequency(f) - botbin) / std::max(1, topbin - botbin);
+            return y + texture_h - 1 - std::clamp(level, 0.0f, 1.0f) * (texture_h - 1);
+        };
+        beginPath();
+        for (size_t c = first + 1; c < count; c++) {
+            const float px = x + (n_columns - (count - c)) * column_w + column_w / 2.0f;
+            for (const auto* p = partials.columnBegin(c); p != partials.columnEnd(c); p++) {
+                if (p->prev == 0) continue;
+                moveTo(px - column_w, yAt((p - p->prev)->frequency));
+                lineTo(px, yAt(p->frequency));
+            }
+        }
+        strokeColor(Color(255, 96, 255, 192));
+        strokeWidth(1.0f);
+        stroke();
+    }
+
+    // Noise floor: Gate clears what isn't Threshold dB over the floor, so Threshold is in dB
+    // above the floor while gating and the linear cutoff comes back after. Normalize puts the
+    // floor at the bottom of the dB range. Columns are changed as they're analysed, changing
+    // either one re-analyses the history.
+    float linear_threshold = 0.0f;
+    float floor_above_db = 6.0f;
+
+    FloorMode noiseFloorMode()
+    {
+        return static_cast<FloorMode>(static_cast<int>(dragfloat_noise_floor->getValue()));
+    }
+
+    float manualThreshold()
+    {
+        return noiseFloorMode() == kFloorGate ? 0.0f : dragfloat_threshold->getValue();
+    }
+
+    void setNoiseFloorMode(FloorMode mode)
+    {
+        const bool gating = mode == kFloorGate;
+        if (gating != (columns_l.flooring == kFloorGate)) {
+            if (gating) {
+                linear_threshold = dragfloat_threshold->getValue();
+                dragfloat_threshold->setRange(0, 40);
+                dragfloat_threshold->setDefault(6.0);
+                dragfloat_threshold->setStep(0.5);
+                dragfloat_threshold->setValue(floor_above_db, false);
+                dragfloat_threshold->unit = "dB";
+            } else {
+                floor_above_db = dragfloat_threshold->getValue();
+                dragfloat_threshold->setRange(0, 1.0);
+                dragfloat_threshold->setDefault(0.0);
+                dragfloat_threshold->setStep(0.001);
+                dragfloat_threshold->setValue(linear_threshold, false);
+                dragfloat_threshold->unit = "";
+            }
+        }
+        changeEngines([&](auto& cols) {
+            cols.flooring = mode;
+            cols.floor_above_db = floor_above_db;
+            cols.floor_reference_db = db_floor;
+            cols.noise_floor.reset();
+        });
+    }
+
+    // dB display: columns carry bins_db, changing the range or gain only remaps them
+    Button dbButton;
+    bool decibels = false;
+    float db_floor = -120.0f;
+    float db_ceiling = 0.0f;
+    float gain_db = 0.0f;
+
     static constexpr int texture_w = 1000;
     static constexpr int texture_h = 460;
     static constexpr int column_w = 2;
     static constexpr int n_columns = (texture_w / column_w);
+    static constexpr int strip_y = 16 + texture_h + 8;
+    static constexpr int strip_h = 64;
+    static constexpr int controls_y = strip_y + strip_h + 12;
+    static constexpr int controls2_y = controls_y + 45;
+    static constexpr int overlay_w = 240;
+
+    Filterbank filterbank;
+    float zoom_lo = 0.0f;
+    float zoom_hi = 0.0f;
 
     Button colorsButton;
     Button peakButton;
     bool peakBinsOnly = false;
+    Button multiresButton;
+    Button trackerButton;
+
+    // Sliding DFT on the horizontal cursor and pinned frequencies, one envelope value per
+    // strip pixel every tracker_decimation samples
+    SlidingDFT tracker_l;
+    SlidingDFT tracker_r;
+    bool tracking = false;
+    std::vector<float> pinned_frequencies;
+    static constexpr uint32_t tracker_decimation = 16;
+
+    void updateTrackerFrequencies()
+    {
+        float f[SlidingDFT::max_tracks];
+        int n = 0;
+        if (cursor2_placed) f[n++] = freqAtBin(cursor2_bin);
+        for (float p : pinned_frequencies) {
+            if (n < SlidingDFT::max_tracks) f[n++] = p;
+        }
+        tracker_l.setFrequencies(f, n);
+        tracker_r.setFrequencies(f, n);
+    }
+
+    Color trackColor(int track)
+    {
+        if (track == 0 && cursor2_placed) return Color(255, 255, 255);
+        auto& c = cmaps["turbo"][32 + track * 28];
+        return Color(c[0], c[1], c[2]);
+    }
+
+    void drawTrackerStrip(float x, float y)
+    {
+        beginPath();
+        roundedRect(x, y, texture_w, strip_h, 4);
+        fillColor(Color(0, 0, 0));
+        fill();
+        strokeColor(Color(255,255,255,64));
+        stroke();
+
+        for (int k = 0; k < tracker_l.n_tracks; k++) {
+            beginPath();
+            for (int i = 0; i < texture_w; i++) {
+                float v = withGain(levelOf(std::max(tracker_l.magnitudeAt(k, i), tracker_r.magnitudeAt(k, i))));
+                float py = y + strip_h - 1 - v * (strip_h - 2);
+                if (i == 0) moveTo(x + i, py);
+                else lineTo(x + i, py);
+            }
+            strokeColor(trackColor(k));
+            stroke();
+        }
+
+        // phase of the first track, left channel
+        if (tracker_l.n_tracks > 0) {
+            beginPath();
+            for (int i = 0; i < texture_w; i++) {
+                float py = y + strip_h / 2 - tracker_l.phaseAt(0, i) / M_PI * (strip_h / 2 - 1);
+                if (i == 0) moveTo(x + i, py);
+                else lineTo(x + i, py);
+            }
+            strokeColor(Color(255, 255, 255, 48));
+            stroke();
+        }
+
+        char label[32];
+        for (int k = 0; k < std::min(tracker_l.n_tracks, 4); k++) {
+            std::snprintf(label, sizeof(label), "%3.3fHz", tracker_l.frequencies[k]);
+            fillColor(trackColor(k));
+            text(122 + texture_w + 10, y + 12 + k * 15, label, nullptr);
+        }
+        fillColor(Color(1.f, 1.f, 1.f));
+    }
 
     struct Pixel{
         uint8_t r;
@@ -818,13 +2658,50 @@ private:
     float lerp(float a, float b, float t) { return a + t * (b - a); }
     float inverseLerp(float a, float b, float value) { return (value - a) / (b - a); }
     float remap(float value, float fromA, float fromB, float toA, float toB) { return lerp(toA, toB, inverseLerp(fromA, fromB, value)); }
-    float interpolate(float x, std::vector<float> bins, size_t size) const {
+    template <typename V>
+    float interpolate(float x, const V& bins, size_t size) const {
         int lowerIndex = static_cast<int>(x);
         int upperIndex = lowerIndex + 1;
         float weight = x - lowerIndex;
         return bins[lowerIndex] * (1 - weight) + bins[upperIndex] * weight;
     }
 
+    // Colormap position before gain: linear magnitude, or bins_db between floor and ceiling
+    template <typename C>
+    float levelAt(const C& col, float at) const
+    {
+        if (decibels) return (interpolate(at, col.bins_db, col.size) - db_floor) / (db_ceiling - db_floor);
+        return interpolate(at, col.bins, col.size);
+    }
+
+    template <typename C>
+    float levelAtBin(const C& col, int bin) const
+    {
+        if (decibels) return (col.bins_db[bin] - db_floor) / (db_ceiling - db_floor);
+        return col.bins[bin];
+    }
+
+    float levelOf(float magnitude) const
+    {
+        if (decibels) return (20 * std::log10(std::max(magnitude, 1e-20f)) - db_floor) / (db_ceiling - db_floor);
+        return magnitude;
+    }
+
+    // Colormap position of a bin's deviation: instantaneous frequency within 2 bins either side
+    // of the bin centre, group delay within a quarter window either side of the frame centre
+    float deviationLevel(float deviation) const
+    {
+        const float range = columns_l.deriving == kDeriveDelay ? columns_l.window_size / 4.0f : 2.0f;
+        return std::clamp(0.5f + 0.5f * deviation / range, 0.0f, 1.0f);
+    }
+
+    // Multiplier is a gain in dB mode, result is clamped to the colormap
+    float withGain(float v) const
+    {
+        v = decibels ? v + gain_db / (db_ceiling - db_floor) : v * multiplier;
+        return std::clamp(v, 0.0f, 1.0f);
+    }
+
     void shiftRasteredColumns(int total_columns, int w, int n_columns)
     {
         for (int y = 0; y < texture_h; y++)
@@ -836,18 +2713,34 @@ private:
         }
     }
 
+    // Columns still waiting for re-analysis stay black
     template <size_t size_x, size_t size_y>
-    void rasterColumnMaxLR(Columns::Column col_l, Columns::Column col_r, int at_x, int w, Pixel tex_l[size_x][size_y], Pixel tex_r[size_x][size_y])
+    void clearRasteredColumn(int at_x, int w, Pixel tex[size_x][size_y])
     {
+        for (int y = 0; y < texture_h; y++)
+        {
+            for (int x = at_x; x < at_x + w; x++) {
+                tex[x][y].r = 0;
+                tex[x][y].g = 0;
+                tex[x][y].b = 0;
+                tex[x][y].a = 255;
+            }
+        }
+    }
+
+    template <size_t size_x, size_t size_y, typename C>
+    void rasterColumnMaxLR(const C& col_l, const C& col_r, int at_x, int w, Pixel tex_l[size_x][size_y], Pixel tex_r[size_x][size_y])
+    {
+        if (!col_l.processed || !col_r.processed) return clearRasteredColumn<size_x, size_y>(at_x, w, tex_l);
         float at = botbin;
         float step = (topbin - at) / texture_h;
         for (int y = 0; y < texture_h; y++)
         {
             auto at_nearest = static_cast<int>(at);
-            float v = std::max(col_l.bins[at_nearest], col_r.bins[at_nearest]);
-            bool leftOrRight = v == col_l.bins[at_nearest] ? false : true;
+            float v = std::max(levelAtBin(col_l, at_nearest), levelAtBin(col_r, at_nearest));
+            bool leftOrRight = col_r.bins[at_nearest] > col_l.bins[at_nearest];
 
-            if (v < dragfloat_threshold->getValue()
+            if (v < manualThreshold()
                 || (peakBinsOnly && (!col_l.bins_peak[at_nearest] && !col_r.bins_peak[at_nearest])))
             {
                 for (int x = at_x; x < at_x + w; x++) {
@@ -860,42 +2753,49 @@ private:
                 if (peakBinsOnly) {
                     // max is right, peak on left, no peak on right -> use left
                     if (leftOrRight && col_l.bins_peak[at_nearest] && !col_r.bins_peak[at_nearest])
-                        v = interpolate(at, col_l.bins, col_l.size);
+                        v = levelAt(col_l, at);
                     // and the opposite
                     if (!leftOrRight && !col_l.bins_peak[at_nearest] && col_r.bins_peak[at_nearest])
-                        v = interpolate(at, col_r.bins, col_r.size);
+                        v = levelAt(col_r, at);
                 } else {
-                    v = interpolate(at, leftOrRight ? col_r.bins : col_l.bins, leftOrRight ? col_r.size : col_l.size);
+                    v = levelAt(leftOrRight ? col_r : col_l, at);
                 }
-                v *= multiplier;
-                if (v > 1.0) v = 1.0;
+                v = withGain(v);
                 int idx = static_cast<int>(v * 255);
+                // deviation views: the colormap shows the deviation, the level only darkens it
+                float shade = 1.0f;
+                const C& shown = leftOrRight ? col_r : col_l;
+                if (!shown.bins_deviation.empty() && columns_l.deriving != kDeriveReassign) {
+                    shade = v;
+                    idx = static_cast<int>(deviationLevel(shown.bins_deviation[at_nearest]) * 255);
+                }
                 for (int x = at_x; x < at_x + w; x++) {
-                    tex_l[x][(texture_h - 1) - y].r = (cmaps[colors[colorsId]][idx][0]) * 255;
-                    tex_l[x][(texture_h - 1) - y].g = (cmaps[colors[colorsId]][idx][1]) * 255;
-                    tex_l[x][(texture_h - 1) - y].b = (cmaps[colors[colorsId]][idx][2]) * 255;
+                    tex_l[x][(texture_h - 1) - y].r = (cmaps[colors[colorsId]][idx][0]) * 255 * shade;
+                    tex_l[x][(texture_h - 1) - y].g = (cmaps[colors[colorsId]][idx][1]) * 255 * shade;
+                    tex_l[x][(texture_h - 1) - y].b = (cmaps[colors[colorsId]][idx][2]) * 255 * shade;
                     tex_l[x][(texture_h - 1) - y].a = 255;
                 }
             }
             at += step;
         }
+        markHarmonics<size_x, size_y>(col_l, at_x, w, tex_l);
+        if (&col_r != &col_l) markHarmonics<size_x, size_y>(col_r, at_x, w, tex_l);
+        markFormants<size_x, size_y>(col_l, at_x, w, tex_l);
+        if (&col_r != &col_l) markFormants<size_x, size_y>(col_r, at_x, w, tex_l);
     }
 
-    template <size_t size_x, size_t size_y>
-    void rasterColumnAddLR(Columns::Column col_l, Columns::Column col_r, int at_x, int w, Pixel tex_l[size_x][size_y], Pixel tex_r[size_x][size_y], bool leftOrRight)
+    template <size_t size_x, size_t size_y, typename C>
+    void rasterColumnAddLR(const C& col_l, const C& col_r, int at_x, int w, Pixel tex_l[size_x][size_y], Pixel tex_r[size_x][size_y], bool leftOrRight)
     {
+        if (!col_l.processed || !col_r.processed) return clearRasteredColumn<size_x, size_y>(at_x, w, tex_l);
         float at = botbin;
         float step = (topbin - at) / texture_h;
         for (int y = 0; y < texture_h; y++)
         {
-            float v_l = interpolate(at, col_l.bins, col_l.size);
-            v_l *= multiplier;
-            if (v_l > 1.0) v_l = 1.0;
+            float v_l = withGain(levelAt(col_l, at));
             if (peakBinsOnly && !col_l.bins_peak[static_cast<int>(at)]) v_l = 0.0f;
             
-            float v_r = interpolate(at, col_r.bins, col_r.size);
-            v_r *= multiplier;
-            if (v_r > 1.0) v_r = 1.0;
+            float v_r = withGain(levelAt(col_r, at));
             if (peakBinsOnly && !col_r.bins_peak[static_cast<int>(at)]) v_r = 0.0f;
             
             for (int x = at_x; x < at_x + w; x++) {
@@ -906,8 +2806,61 @@ private:
             }
             at += step;
         }
+        markHarmonics<size_x, size_y>(col_l, at_x, w, tex_l);
+        if (&col_r != &col_l) markHarmonics<size_x, size_y>(col_r, at_x, w, tex_l);
+        markFormants<size_x, size_y>(col_l, at_x, w, tex_l);
+        if (&col_r != &col_l) markFormants<size_x, size_y>(col_r, at_x, w, tex_l);
     }
 
+    // Rows of the harmonic series peaks, the fundamental in cyan and the rest in white
+    template <size_t size_x, size_t size_y, typename C>
+    void markHarmonics(const C& col, int at_x, int w, Pixel tex[size_x][size_y])
+    {
+        if (overlayMode() != kOverlayHarmonics || col.harmonic.f0 <= 0.0f || col.harmonic.salience < harmonic_min_salience_db)
+            return;
+        const float step = (topbin - botbin) / static_cast<float>(texture_h);
+        for (unsigned h = 0; h < HarmonicSeries::max_harmonics; h++) {
+            const int bin = col.harmonic.bins[h];
+            if (bin < botbin || bin >= topbin) continue;
+            // every row whose nearest bin is this one, at least one
+            const int y_lo = static_cast<int>(std::ceil((bin - botbin) / step));
+            const int y_hi = std::max(y_lo + 1, static_cast<int>(std::ceil((bin + 1 - botbin) / step)));
+            for (int y = y_lo; y < std::min(y_hi, texture_h); y++) {
+                for (int x = at_x; x < at_x + w; x++) {
+                    Pixel& p = tex[x][(texture_h - 1) - y];
+                    p.r = h == 0 ? 64 : 255;
+                    p.g = 255;
+                    p.b = 255;
+                    p.a = 255;
+                }
+            }
+        }
+    }
+
+    // Rows of the formants, two each so the tracks read at a glance
+    template <size_t size_x, size_t size_y, typename C>
+    void markFormants(const C& col, int at_x, int w, Pixel tex[size_x][size_y])
+    {
+        if (overlayMode() != kOverlayLPC) return;
+        const float step = (topbin - botbin) / static_cast<float>(texture_h);
+        for (unsigned f = 0; f < col.lpc.n_formants; f++) {
+            const int y = static_cast<int>(std::lround((binAtFrequency(col.lpc.formants[f]) - botbin) / step));
+            for (int row = y; row < y + 2; row++) {
+                if (row < 0 || row >= texture_h) continue;
+                for (int x = at_x; x < at_x + w; x++) {
+                    Pixel& p = tex[x][(texture_h - 1) - row];
+                    p.r = 255;
+                    p.g = 64;
+                    p.b = 160;
+                    p.a = 255;
+                }
+            }
+        }
+    }
+
+    // Declared last so its threads are joined before anything they use goes away
+    WorkerPool pool;
+
    /**
       Set our UI class as non-copyable and add a leak detector just in case.
     */
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include "pocketfft_cached.hpp"
+#include "simde/x86/avx2.h"
+
+// |X|^2 into the real part and 0 into the imaginary one, two bins at a time
+inline void power_in_place(std::complex<double> * x, unsigned n)
+{
+    double * d = reinterpret_cast<double *>(x);
+    unsigned i;
+    for (i = 0; i < n - n % 2; i += 2)
+    {
+        simde__m256d v = simde_mm256_loadu_pd(&d[2 * i]);
+        simde__m256d sq = simde_mm256_mul_pd(v, v);
+        // re^2 + im^2 in both lanes of each bin, the odd lanes cleared
+        simde__m256d p = simde_mm256_hadd_pd(sq, sq);
+        simde_mm256_storeu_pd(&d[2 * i], simde_mm256_blend_pd(p, simde_mm256_setzero_pd(), 0xA));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        x[k] = std::norm(x[k]);
+    }
+}
+
+// Linear autocorrelation through the power spectrum of the input zero padded to at least twice
+// its length, a power of two so odd lengths don't end up on slow FFT sizes
+struct Autocorrelation {
+    std::vector<double> padded;
+    std::vector<std::complex<double>> spectrum;
+    std::vector<double> acf;
+
+    // up to n samples, lags 0 to n - 1
+    void init(size_t n)
+    {
+        size_t fft_size = 2;
+        while (fft_size < 2 * n) fft_size *= 2;
+        padded.assign(fft_size, 0.0);
+        spectrum.resize(fft_size / 2 + 1);
+        acf.resize(fft_size);
+    }
+
+    size_t size() const { return padded.size() / 2; }
+
+    // acf[tau] = sum of x[j] x[j + tau], n at most size()
+    const std::vector<double>& compute(const double* x, size_t n)
+    {
+        std::copy(x, x + n, padded.begin());
+        std::fill(padded.begin() + n, padded.end(), 0.0);
+        pocketfft::r2c(
+            pocketfft::shape_t{padded.size()},
+            pocketfft::stride_t{sizeof(double)},
+            pocketfft::stride_t{sizeof(std::complex<double>)},
+            0,
+            pocketfft::FORWARD,
+            padded.data(),
+            spectrum.data(),
+            1.0
+        );
+        power_in_place(spectrum.data(), spectrum.size());
+        pocketfft::c2r(
+            pocketfft::shape_t{padded.size()},
+            pocketfft::stride_t{sizeof(std::complex<double>)},
+            pocketfft::stride_t{sizeof(double)},
+            0,
+            pocketfft::BACKWARD,
+            spectrum.data(),
+            acf.data(),
+            1.0 / padded.size()
+        );
+        return acf;
+    }
+};
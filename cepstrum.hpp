@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+// Natural log magnitudes from dB into the real parts of out, imaginary parts cleared, ready for
+// the inverse real FFT. Anything under floor_db counts as floor_db, so near-empty bins don't
+// turn into huge negative logs that ring across every quefrency.
+void db_to_log_spectrum(const float * db, std::complex<float> * out, unsigned n, float floor_db)
+{
+    float * f = reinterpret_cast<float *>(out);
+    const simde__m256 nepers_per_db = simde_mm256_set1_ps(std::log(10.0f) / 20.0f);
+    const simde__m256 fl = simde_mm256_set1_ps(floor_db);
+    const simde__m256 zero = simde_mm256_setzero_ps();
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_mul_ps(simde_mm256_max_ps(simde_mm256_loadu_ps(&db[i]), fl), nepers_per_db);
+        // interleaved with zeros within each lane, then the lanes put back in order
+        simde__m256 lo = simde_mm256_unpacklo_ps(v, zero);
+        simde__m256 hi = simde_mm256_unpackhi_ps(v, zero);
+        simde_mm256_storeu_ps(&f[2 * i], simde_mm256_permute2f128_ps(lo, hi, 0x20));
+        simde_mm256_storeu_ps(&f[2 * i + 8], simde_mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::max(db[k], floor_db) * std::log(10.0f) / 20.0f;
+    }
+}
+
+void db_to_log_spectrum(const float * db, std::complex<double> * out, unsigned n, float floor_db)
+{
+    double * d = reinterpret_cast<double *>(out);
+    const simde__m256d nepers_per_db = simde_mm256_set1_pd(std::log(10.0) / 20.0);
+    const simde__m128 fl = simde_mm_set1_ps(floor_db);
+    const simde__m256d zero = simde_mm256_setzero_pd();
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d v = simde_mm256_mul_pd(simde_mm256_cvtps_pd(simde_mm_max_ps(simde_mm_loadu_ps(&db[i]), fl)), nepers_per_db);
+        simde__m256d lo = simde_mm256_unpacklo_pd(v, zero);
+        simde__m256d hi = simde_mm256_unpackhi_pd(v, zero);
+        simde_mm256_storeu_pd(&d[2 * i], simde_mm256_permute2f128_pd(lo, hi, 0x20));
+        simde_mm256_storeu_pd(&d[2 * i + 4], simde_mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::max(db[k], floor_db) * std::log(10.0) / 20.0;
+    }
+}
+
+// out[i] = |c[i]| * lifter[i]
+void lifter_magnitudes(const float * c, const float * lifter, float * out, unsigned n)
+{
+    const simde__m256 sign = simde_mm256_set1_ps(-0.0f);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_andnot_ps(sign, simde_mm256_loadu_ps(&c[i]));
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&lifter[i])));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::abs(c[k]) * lifter[k];
+    }
+}
+
+void lifter_magnitudes(const double * c, const double * lifter, double * out, unsigned n)
+{
+    const simde__m256d sign = simde_mm256_set1_pd(-0.0);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d v = simde_mm256_andnot_pd(sign, simde_mm256_loadu_pd(&c[i]));
+        simde_mm256_storeu_pd(&out[i], simde_mm256_mul_pd(v, simde_mm256_loadu_pd(&lifter[i])));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::abs(c[k]) * lifter[k];
+    }
+}
+
+// Short-pass rejecting lifter over n quefrency bins: 0 under cutoff / 2, a raised cosine up to
+// cutoff and 1 from there on. A cutoff of 0 leaves every bin alone.
+template <typename T>
+void make_lifter(std::vector<T>& w, size_t n, float cutoff)
+{
+    w.assign(n, T(1));
+    if (cutoff <= 0.0f) return;
+    const float start = 0.5f * cutoff;
+    for (size_t q = 0; q < std::min<size_t>(n, std::ceil(cutoff)); q++)
+    {
+        if (q <= start) w[q] = T(0);
+        else w[q] = static_cast<T>(0.5 - 0.5 * std::cos(M_PI * (q - start) / (cutoff - start)));
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+#include "SimdUtils.hpp"
+
+enum ChannelMode {
+    kChannelsLR = 0,
+    kChannelsMS,
+    kChannelsL,
+    kChannelsR,
+    kChannelsM,
+    kChannelsS,
+    kChannelsMatrix,
+    kChannelsCount
+};
+
+// 2x2 matrix applied to the L/R blocks before analysis: first = a L + b R, second = c L + d R.
+// Single channel modes only compute the first output, the second engine isn't fed at all.
+struct ChannelMatrix {
+    float a = 1.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float d = 1.0f;
+    bool single = false;
+    bool identity = true;
+
+    // custom holds a, b, c, d for kChannelsMatrix
+    void set(ChannelMode mode, const float custom[4])
+    {
+        single = mode >= kChannelsL && mode <= kChannelsS;
+        identity = mode == kChannelsLR;
+        switch (mode) {
+            case kChannelsLR:     setCoefficients(1.0f, 0.0f, 0.0f, 1.0f); break;
+            case kChannelsMS:     setCoefficients(0.5f, 0.5f, 0.5f, -0.5f); break;
+            case kChannelsL:      setCoefficients(1.0f, 0.0f, 0.0f, 0.0f); break;
+            case kChannelsR:      setCoefficients(0.0f, 1.0f, 0.0f, 0.0f); break;
+            case kChannelsM:      setCoefficients(0.5f, 0.5f, 0.0f, 0.0f); break;
+            case kChannelsS:      setCoefficients(0.5f, -0.5f, 0.0f, 0.0f); break;
+            case kChannelsMatrix: setCoefficients(custom[0], custom[1], custom[2], custom[3]); break;
+            default: break;
+        }
+    }
+
+    void setCoefficients(float _a, float _b, float _c, float _d)
+    {
+        a = _a;
+        b = _b;
+        c = _c;
+        d = _d;
+    }
+
+    void apply(const float* l, const float* r, float* first, float* second, size_t n) const
+    {
+        if (single) simd_buffer_mix(l, r, first, n, a, b);
+        else simd_buffer_matrix(l, r, first, second, n, a, b, c, d);
+    }
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "pocketfft_cached.hpp"
+#include "simde/x86/avx2.h"
+#include "workers.hpp"
+
+// acc[i] += x[i] * w[i], the products of one stretch of spectrum folded onto the output grid
+void weighted_fold(const float * x, const float * w, float * acc, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 p = simde_mm256_mul_ps(simde_mm256_loadu_ps(&x[i]), simde_mm256_loadu_ps(&w[i]));
+        simde_mm256_storeu_ps(&acc[i], simde_mm256_add_ps(simde_mm256_loadu_ps(&acc[i]), p));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        acc[k] += x[k] * w[k];
+    }
+}
+
+// Continuous wavelet transform on log-spaced scales with analytic Morlet (Gabor) wavelets,
+// streamed block-wise with overlap-save: one real FFT per block, then every scale multiplies it
+// by its Gaussian frequency response and transforms back. Only every hop-th output sample is
+// kept, so the product is folded onto block / hop points and the inverse runs at that length.
+// The longest wavelet spans `support` samples, which sets the lowest scale; the highest sits
+// three deviations under Nyquist. A sine reads its amplitude, as in the STFT view.
+struct MorletCWT {
+    float sampleRate;
+    float omega0;
+    uint32_t n_scales;
+    uint32_t hop_size;
+    // wavelet support rounded up to whole hops either side, block length and the samples a block
+    // moves on, a multiple of hop_size
+    uint32_t support;
+    uint32_t block_size;
+    uint32_t advance;
+    uint32_t fold_size;
+
+    // Gaussians cropped to 4 deviations, each weight twice over to match the interleaved spectrum
+    std::vector<float> centers;
+    std::vector<uint32_t> first_bin;
+    std::vector<uint32_t> n_bins;
+    std::vector<size_t> response_offset;
+    std::vector<float> responses;
+
+    std::vector<float> block;
+    std::vector<std::complex<float>> spectrum;
+    // one row of n_scales per column of the block
+    std::vector<float> magnitudes;
+    std::vector<float> phases;
+    std::vector<float> bins;
+    std::vector<float> bins_phase;
+
+    // Scales are split into groups of scales_per_task, spread over the caller's pool when one is
+    // given. The pool isn't owned: the UI lends its re-analysis pool, which is idle while the
+    // scalogram is shown since the scalogram's history isn't re-analysed.
+    static constexpr uint32_t scales_per_task = 8;
+    struct Scratch {
+        std::vector<std::complex<float>> folded;
+        std::vector<std::complex<float>> output;
+    };
+    std::vector<Scratch> scratch;
+    WorkerPool* pool = nullptr;
+
+    pocketfft::shape_t shape{0};
+    pocketfft::shape_t fold_shape{0};
+    pocketfft::stride_t stride_in{sizeof(float)};
+    pocketfft::stride_t stride_out{sizeof(std::complex<float>)};
+
+    size_t size() const { return n_scales; }
+
+    float frequencyAt(size_t bin) const { return centers[bin]; }
+
+    size_t columnsPerBlock() const { return advance / hop_size; }
+
+    // Length of the Hann window with the same time spread as the wavelet of a scale, in seconds
+    float frameSeconds(size_t bin) const
+    {
+        return 7.1f * omega0 / (2 * M_PI * centers[bin]);
+    }
+
+    void init(float _sampleRate, uint32_t _n_scales, uint32_t _support, uint32_t _hop_size,
+              float _omega0 = 6.0f, WorkerPool* _pool = nullptr)
+    {
+        sampleRate = _sampleRate;
+        n_scales = std::max(2u, _n_scales);
+        hop_size = std::max(1u, _hop_size);
+        omega0 = _omega0;
+
+        // 4 deviations either side of the centre, whole hops so the kept outputs land on the fold
+        support = 2 * hop_size * ((std::max(_support, 2u) + 2 * hop_size - 1) / (2 * hop_size));
+        // at least twice the support so a block keeps half its outputs
+        uint32_t m = 1;
+        while (m * hop_size < 2 * support) m *= 2;
+        fold_size = m;
+        block_size = m * hop_size;
+        advance = block_size - support;
+
+        // sigma_t = omega0 / (2 pi f) seconds, 8 of them fill the support
+        const float f_lo = 8 * omega0 * sampleRate / (2 * M_PI * support);
+        const float f_hi = std::max(f_lo * 2, sampleRate / 2 / (1 + 3 / omega0));
+        centers.resize(n_scales);
+        for (uint32_t s = 0; s < n_scales; s++)
+        {
+            centers[s] = f_lo * std::pow(f_hi / f_lo, static_cast<float>(s) / (n_scales - 1));
+        }
+
+        const uint32_t half = block_size / 2;
+        const double hz_per_bin = static_cast<double>(sampleRate) / block_size;
+        first_bin.resize(n_scales);
+        n_bins.resize(n_scales);
+        response_offset.resize(n_scales);
+        responses.clear();
+        for (uint32_t s = 0; s < n_scales; s++)
+        {
+            const double sigma = centers[s] / omega0 / hz_per_bin;
+            const double centre = centers[s] / hz_per_bin;
+            const uint32_t lo = std::max<int64_t>(1, std::ceil(centre - 4 * sigma));
+            const uint32_t hi = std::min<int64_t>(half, std::floor(centre + 4 * sigma));
+            first_bin[s] = lo;
+            n_bins[s] = hi >= lo ? hi - lo + 1 : 0;
+            response_offset[s] = responses.size();
+            for (uint32_t k = lo; k <= hi; k++)
+            {
+                const double x = (k - centre) / sigma;
+                // doubled for the analytic signal, the inverse scale 1 / block_size comes along
+                const float w = 2.0 * std::exp(-0.5 * x * x) / block_size;
+                responses.push_back(w);
+                responses.push_back(w);
+            }
+        }
+
+        shape[0] = block_size;
+        fold_shape[0] = fold_size;
+        block.assign(support / 2, 0.0f);
+        block.reserve(block_size);
+        spectrum.resize(half + 1);
+        magnitudes.resize(columnsPerBlock() * n_scales);
+        phases.resize(columnsPerBlock() * n_scales);
+        bins.resize(n_scales);
+        bins_phase.resize(n_scales);
+
+        pool = _pool && _pool->size() > 1 ? _pool : nullptr;
+        scratch.resize(pool ? pool->size() : 1);
+        for (auto& sc : scratch)
+        {
+            sc.folded.resize(fold_size);
+            sc.output.resize(fold_size);
+        }
+    }
+
+    // Folds the spectrum weighted by the response of scale s onto fold_size points, back to time
+    // and keeps the outputs between the support halves
+    void transformScale(uint32_t s, Scratch& sc)
+    {
+        std::fill(sc.folded.begin(), sc.folded.end(), std::complex<float>(0.0f));
+        const float* w = &responses[response_offset[s]];
+        float* acc = reinterpret_cast<float*>(sc.folded.data());
+        const float* x = reinterpret_cast<const float*>(spectrum.data());
+        uint32_t k = first_bin[s];
+        const uint32_t end = k + n_bins[s];
+        while (k < end)
+        {
+            const uint32_t r = k % fold_size;
+            const uint32_t run = std::min(end - k, fold_size - r);
+            weighted_fold(&x[2 * k], w, &acc[2 * r], 2 * run);
+            w += 2 * run;
+            k += run;
+        }
+        pocketfft::c2c(fold_shape, stride_out, stride_out, {0}, pocketfft::BACKWARD, sc.folded.data(), sc.output.data(), 1.0f);
+
+        const uint32_t first = support / 2 / hop_size;
+        for (uint32_t j = 0; j < columnsPerBlock(); j++)
+        {
+            const std::complex<float> v = sc.output[first + j];
+            magnitudes[j * n_scales + s] = std::abs(v);
+            phases[j * n_scales + s] = std::arg(v);
+        }
+    }
+
+    void transform()
+    {
+        pocketfft::r2c(shape, stride_in, stride_out, 0, pocketfft::FORWARD, block.data(), spectrum.data(), 1.0f);
+        const size_t tasks = (n_scales + scales_per_task - 1) / scales_per_task;
+        auto run = [this](size_t task, size_t worker) {
+            const uint32_t lo = task * scales_per_task;
+            const uint32_t hi = std::min(n_scales, lo + scales_per_task);
+            for (uint32_t s = lo; s < hi; s++) transformScale(s, scratch[worker]);
+        };
+        if (pool) {
+            pool->submit(tasks, run);
+            pool->wait();
+        } else {
+            for (size_t task = 0; task < tasks; task++) run(task, 0);
+        }
+    }
+
+    // Calls emit() after each new column, bins/bins_phase hold the result. The first column is
+    // centred on the first sample fed.
+    template <typename F>
+    int process(const float* data, size_t length, F&& emit)
+    {
+        int fed = 0;
+        size_t idx = 0;
+        while (idx < length)
+        {
+            const size_t eat = std::min(static_cast<size_t>(block_size - block.size()), length - idx);
+            block.insert(block.end(), data + idx, data + idx + eat);
+            idx += eat;
+            if (block.size() == block_size) {
+                transform();
+                for (uint32_t j = 0; j < columnsPerBlock(); j++)
+                {
+                    std::copy(&magnitudes[j * n_scales], &magnitudes[(j + 1) * n_scales], bins.begin());
+                    std::copy(&phases[j * n_scales], &phases[(j + 1) * n_scales], bins_phase.begin());
+                    emit();
+                    fed++;
+                }
+                block.erase(block.begin(), block.begin() + advance);
+            }
+        }
+        return fed;
+    }
+};
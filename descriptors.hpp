@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "simde/x86/avx2.h"
+
+// Per-column spectral shape. Centroid and spread weigh frequencies by magnitude, rolloff,
+// flatness and entropy work on power, crest on magnitude.
+struct SpectralDescriptors {
+    float centroid = 0.0f;  // Hz
+    float spread = 0.0f;    // Hz, standard deviation around the centroid
+    float rolloff85 = 0.0f; // Hz, frequency under which 85% of the power sits
+    float rolloff95 = 0.0f; // Hz, same for 95%
+    float flatness = 0.0f;  // geometric over arithmetic mean of the power, 0 tonal to 1 white
+    float crest = 0.0f;     // peak over mean magnitude
+    float flux = 0.0f;      // sum of the magnitude increases since the previous column
+    float entropy = 0.0f;   // of the power distribution, normalised to 0..1
+};
+
+enum DescriptorKind {
+    kDescriptorOff = 0,
+    kDescriptorCentroid,
+    kDescriptorSpread,
+    kDescriptorRolloff85,
+    kDescriptorRolloff95,
+    kDescriptorFlatness,
+    kDescriptorCrest,
+    kDescriptorFlux,
+    kDescriptorEntropy,
+    kDescriptorCount
+};
+
+inline float descriptorValue(const SpectralDescriptors& d, DescriptorKind kind)
+{
+    switch (kind) {
+        case kDescriptorCentroid:  return d.centroid;
+        case kDescriptorSpread:    return d.spread;
+        case kDescriptorRolloff85: return d.rolloff85;
+        case kDescriptorRolloff95: return d.rolloff95;
+        case kDescriptorFlatness:  return d.flatness;
+        case kDescriptorCrest:     return d.crest;
+        case kDescriptorFlux:      return d.flux;
+        case kDescriptorEntropy:   return d.entropy;
+        default: break;
+    }
+    return 0.0f;
+}
+
+// Sums over the bins gathered in one pass, the dB values are the ones the column already has
+struct SpectrumSums {
+    double magnitude = 0.0;     // sum m
+    double first_moment = 0.0;  // sum f m
+    double second_moment = 0.0; // sum f^2 m
+    double power = 0.0;         // sum m^2
+    double db = 0.0;            // sum 20 log10 m
+    double power_db = 0.0;      // sum m^2 20 log10 m
+    double max = 0.0;
+};
+
+static inline double hsum_ps(simde__m256 v)
+{
+    float lanes[8];
+    simde_mm256_storeu_ps(lanes, v);
+    return static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+static inline double hsum_pd(simde__m256d v)
+{
+    double lanes[4];
+    simde_mm256_storeu_pd(lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Bin k sits at freqs[k], or at f0 + k df when freqs is null
+void spectrum_sums(const float * m, const float * db, const float * freqs, float f0, float df, unsigned n, SpectrumSums& s)
+{
+    const simde__m256 iota = simde_mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0);
+    const simde__m256 vdf = simde_mm256_set1_ps(df);
+    simde__m256 sp = simde_mm256_setzero_ps(), sdb = sp, spdb = sp, mx = sp;
+    // the moments are summed in double, the spread comes from their difference
+    simde__m256d s0 = simde_mm256_setzero_pd(), s1 = s0, s2 = s0;
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_loadu_ps(&m[i]);
+        simde__m256 d = simde_mm256_loadu_ps(&db[i]);
+        simde__m256 f = freqs ? simde_mm256_loadu_ps(&freqs[i])
+                              : simde_mm256_add_ps(simde_mm256_set1_ps(f0 + df * i), simde_mm256_mul_ps(iota, vdf));
+        simde__m256 fm = simde_mm256_mul_ps(f, v);
+        simde__m256 p = simde_mm256_mul_ps(v, v);
+        simde__m256d fm_lo = simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(fm));
+        simde__m256d fm_hi = simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(fm, 1));
+        s0 = simde_mm256_add_pd(s0, simde_mm256_add_pd(simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(v)),
+                                                       simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(v, 1))));
+        s1 = simde_mm256_add_pd(s1, simde_mm256_add_pd(fm_lo, fm_hi));
+        s2 = simde_mm256_add_pd(s2, simde_mm256_add_pd(
+            simde_mm256_mul_pd(simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(f)), fm_lo),
+            simde_mm256_mul_pd(simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(f, 1)), fm_hi)));
+        sp = simde_mm256_add_ps(sp, p);
+        sdb = simde_mm256_add_ps(sdb, d);
+        spdb = simde_mm256_add_ps(spdb, simde_mm256_mul_ps(p, d));
+        mx = simde_mm256_max_ps(mx, v);
+    }
+    float lanes[8];
+    simde_mm256_storeu_ps(lanes, mx);
+    s.max = *std::max_element(lanes, lanes + 8);
+    s.magnitude = hsum_pd(s0);
+    s.first_moment = hsum_pd(s1);
+    s.second_moment = hsum_pd(s2);
+    s.power = hsum_ps(sp);
+    s.db = hsum_ps(sdb);
+    s.power_db = hsum_ps(spdb);
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        const double v = m[k], f = freqs ? freqs[k] : f0 + df * k;
+        s.magnitude += v;
+        s.first_moment += f * v;
+        s.second_moment += f * f * v;
+        s.power += v * v;
+        s.db += db[k];
+        s.power_db += v * v * db[k];
+        s.max = std::max(s.max, v);
+    }
+}
+
+void spectrum_sums(const double * m, const float * db, const float * freqs, float f0, float df, unsigned n, SpectrumSums& s)
+{
+    const simde__m256d iota = simde_mm256_set_pd(3, 2, 1, 0);
+    const simde__m256d vdf = simde_mm256_set1_pd(df);
+    simde__m256d s0 = simde_mm256_setzero_pd(), s1 = s0, s2 = s0, sp = s0, sdb = s0, spdb = s0, mx = s0;
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d v = simde_mm256_loadu_pd(&m[i]);
+        simde__m256d d = simde_mm256_cvtps_pd(simde_mm_loadu_ps(&db[i]));
+        simde__m256d f = freqs ? simde_mm256_cvtps_pd(simde_mm_loadu_ps(&freqs[i]))
+                               : simde_mm256_add_pd(simde_mm256_set1_pd(f0 + static_cast<double>(df) * i), simde_mm256_mul_pd(iota, vdf));
+        simde__m256d fm = simde_mm256_mul_pd(f, v);
+        simde__m256d p = simde_mm256_mul_pd(v, v);
+        s0 = simde_mm256_add_pd(s0, v);
+        s1 = simde_mm256_add_pd(s1, fm);
+        s2 = simde_mm256_add_pd(s2, simde_mm256_mul_pd(f, fm));
+        sp = simde_mm256_add_pd(sp, p);
+        sdb = simde_mm256_add_pd(sdb, d);
+        spdb = simde_mm256_add_pd(spdb, simde_mm256_mul_pd(p, d));
+        mx = simde_mm256_max_pd(mx, v);
+    }
+    double lanes[4];
+    simde_mm256_storeu_pd(lanes, mx);
+    s.max = *std::max_element(lanes, lanes + 4);
+    s.magnitude = hsum_pd(s0);
+    s.first_moment = hsum_pd(s1);
+    s.second_moment = hsum_pd(s2);
+    s.power = hsum_pd(sp);
+    s.db = hsum_pd(sdb);
+    s.power_db = hsum_pd(spdb);
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        const double v = m[k], f = freqs ? freqs[k] : f0 + static_cast<double>(df) * k;
+        s.magnitude += v;
+        s.first_moment += f * v;
+        s.second_moment += f * f * v;
+        s.power += v * v;
+        s.db += db[k];
+        s.power_db += v * v * db[k];
+        s.max = std::max(s.max, v);
+    }
+}
+
+// sum of max(0, m - prev), the half-wave rectified flux
+float spectral_flux(const float * m, const float * prev, unsigned n)
+{
+    const simde__m256 zero = simde_mm256_setzero_ps();
+    simde__m256 acc = zero;
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 d = simde_mm256_sub_ps(simde_mm256_loadu_ps(&m[i]), simde_mm256_loadu_ps(&prev[i]));
+        acc = simde_mm256_add_ps(acc, simde_mm256_max_ps(d, zero));
+    }
+    double sum = hsum_ps(acc);
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        sum += std::max(0.0f, m[k] - prev[k]);
+    }
+    return sum;
+}
+
+float spectral_flux(const double * m, const double * prev, unsigned n)
+{
+    const simde__m256d zero = simde_mm256_setzero_pd();
+    simde__m256d acc = zero;
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d d = simde_mm256_sub_pd(simde_mm256_loadu_pd(&m[i]), simde_mm256_loadu_pd(&prev[i]));
+        acc = simde_mm256_add_pd(acc, simde_mm256_max_pd(d, zero));
+    }
+    double sum = hsum_pd(acc);
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        sum += std::max(0.0, m[k] - prev[k]);
+    }
+    return sum;
+}
+
+// Everything but the flux, which needs the previous column. Rolloff walks the bins once more
+// in blocks of 8 until both thresholds are crossed.
+template <typename T>
+void describe_spectrum(const T* m, const float* db, const float* freqs, float f0, float df, unsigned n, SpectralDescriptors& out)
+{
+    SpectrumSums s;
+    spectrum_sums(m, db, freqs, f0, df, n, s);
+    out = SpectralDescriptors{};
+    if (n == 0 || s.magnitude <= 0.0 || s.power <= 0.0) return;
+
+    auto freq = [&](unsigned k) { return freqs ? freqs[k] : f0 + df * k; };
+    const double centroid = s.first_moment / s.magnitude;
+    out.centroid = centroid;
+    out.spread = std::sqrt(std::max(0.0, s.second_moment / s.magnitude - centroid * centroid));
+    out.crest = s.max * n / s.magnitude;
+
+    // dB of magnitude to natural and base 2 logs of power
+    const double ln_power_per_db = std::log(10.0) / 10.0;
+    const double log2_power_per_db = std::log2(10.0) / 10.0;
+    out.flatness = std::min(1.0, std::exp(s.db * ln_power_per_db / n) / (s.power / n));
+    const double entropy = std::log2(s.power) - s.power_db * log2_power_per_db / s.power;
+    out.entropy = n > 1 ? std::clamp(entropy / std::log2(static_cast<double>(n)), 0.0, 1.0) : 0.0;
+
+    const double at85 = 0.85 * s.power, at95 = 0.95 * s.power;
+    double cumulative = 0.0;
+    unsigned k = 0;
+    bool found85 = false;
+    while (k < n)
+    {
+        // skip whole blocks that stay under the next threshold
+        const unsigned end = std::min(n, k + 8);
+        double block = 0.0;
+        for (unsigned j = k; j < end; j++) block += static_cast<double>(m[j]) * m[j];
+        const double next = found85 ? at95 : at85;
+        if (cumulative + block < next) {
+            cumulative += block;
+            k = end;
+            continue;
+        }
+        for (; k < end; k++)
+        {
+            cumulative += static_cast<double>(m[k]) * m[k];
+            if (!found85 && cumulative >= at85) {
+                out.rolloff85 = freq(k);
+                found85 = true;
+            }
+            if (found85 && cumulative >= at95) {
+                out.rolloff95 = freq(k);
+                return;
+            }
+        }
+    }
+    if (!found85) out.rolloff85 = freq(n - 1);
+    out.rolloff95 = freq(n - 1);
+}
@@ -1,10 +1,29 @@
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <type_traits>
 
-#include "pocketfft.h"
+#include "pocketfft_cached.hpp"
 #include "simde/x86/avx2.h"
+#include "filterbank.hpp"
+#include "zoomfft.hpp"
+#include "traces.hpp"
+#include "noisefloor.hpp"
+#include "welch.hpp"
+#include "transfer.hpp"
+#include "gccphat.hpp"
+#include "descriptors.hpp"
+#include "harmonics.hpp"
+#include "onsets.hpp"
+#include "cepstrum.hpp"
+#include "reassign.hpp"
+#include "multitaper.hpp"
+#include "cwt.hpp"
+#include "lpc.hpp"
 
 // https://github.com/sidneycadot/WindowFunctions/blob/master/c99/window_functions.c
-void cosine_window(float * w, unsigned n, const float * coeff, unsigned ncoeff, bool sflag)
+template <typename T>
+void cosine_window(T * w, unsigned n, const T * coeff, unsigned ncoeff, bool sflag)
 {
     if (n == 1)
     {
@@ -17,7 +36,7 @@ void cosine_window(float * w, unsigned n, const float * coeff, unsigned ncoeff,
 
         for (unsigned i = 0; i < n; ++i)
         {
-            float wi = 0.0;
+            T wi = 0.0;
 
             for (unsigned j = 0; j < ncoeff; ++j)
             {
@@ -29,111 +48,753 @@ void cosine_window(float * w, unsigned n, const float * coeff, unsigned ncoeff,
     }
 }
 
-void hann(float * w, unsigned n, bool sflag)
+template <typename T>
+void hann(T * w, unsigned n, bool sflag)
 {
-    const float coeff[2] = { 0.5, -0.5 };
-    cosine_window(w, n, coeff, sizeof(coeff) / sizeof(float), sflag);
+    const T coeff[2] = { 0.5, -0.5 };
+    cosine_window(w, n, coeff, sizeof(coeff) / sizeof(T), sflag);
 }
 
+// Symmetric Hann windows cached per length, entries are never removed so references stay valid
+template <typename T>
+const std::vector<T>& cached_hann(uint32_t n)
+{
+    static std::map<uint32_t, std::vector<T>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        it = cache.emplace(n, std::vector<T>(n)).first;
+        hann(it->second.data(), n, true);
+    }
+    return it->second;
+}
+
+void apply_window(const float * in, const float * w, float * out, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 buf = simde_mm256_loadu_ps(&in[i]);
+        simde__m256 win = simde_mm256_loadu_ps(&w[i]);
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(buf, win));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = in[k] * w[k];
+    }
+}
+
+void apply_window(const double * in, const double * w, double * out, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d buf = simde_mm256_loadu_pd(&in[i]);
+        simde__m256d win = simde_mm256_loadu_pd(&w[i]);
+        simde_mm256_storeu_pd(&out[i], simde_mm256_mul_pd(buf, win));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = in[k] * w[k];
+    }
+}
+
+// |in[i]| * scale, squares are summed pairwise with hadd then put back in order
+void complex_magnitudes(const std::complex<float> * in, float * out, unsigned n, float scale)
+{
+    const float * f = reinterpret_cast<const float *>(in);
+    simde__m256 s = simde_mm256_set1_ps(scale);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 a = simde_mm256_loadu_ps(&f[2 * i]);
+        simde__m256 b = simde_mm256_loadu_ps(&f[2 * i + 8]);
+        simde__m256 h = simde_mm256_hadd_ps(simde_mm256_mul_ps(a, a), simde_mm256_mul_ps(b, b));
+        h = simde_mm256_castpd_ps(simde_mm256_permute4x64_pd(simde_mm256_castps_pd(h), 0xD8));
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(simde_mm256_sqrt_ps(h), s));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::abs(in[k]) * scale;
+    }
+}
+
+void complex_magnitudes(const std::complex<double> * in, double * out, unsigned n, double scale)
+{
+    const double * d = reinterpret_cast<const double *>(in);
+    simde__m256d s = simde_mm256_set1_pd(scale);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d a = simde_mm256_loadu_pd(&d[2 * i]);
+        simde__m256d b = simde_mm256_loadu_pd(&d[2 * i + 4]);
+        simde__m256d h = simde_mm256_hadd_pd(simde_mm256_mul_pd(a, a), simde_mm256_mul_pd(b, b));
+        h = simde_mm256_permute4x64_pd(h, 0xD8);
+        simde_mm256_storeu_pd(&out[i], simde_mm256_mul_pd(simde_mm256_sqrt_pd(h), s));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::abs(in[k]) * scale;
+    }
+}
+
+// log2 from the float bits: exponent plus a 4th order fit on the mantissa, max error 2e-4 (0.001dB)
+simde__m256 fast_log2(simde__m256 x)
+{
+    const simde__m256i bits = simde_mm256_castps_si256(x);
+    const simde__m256 e = simde_mm256_cvtepi32_ps(
+        simde_mm256_sub_epi32(simde_mm256_srli_epi32(bits, 23), simde_mm256_set1_epi32(127)));
+    const simde__m256 m = simde_mm256_castsi256_ps(simde_mm256_or_si256(
+        simde_mm256_and_si256(bits, simde_mm256_set1_epi32(0x007FFFFF)), simde_mm256_set1_epi32(0x3F800000)));
+    const simde__m256 t = simde_mm256_sub_ps(m, simde_mm256_set1_ps(1.0f));
+    simde__m256 p = simde_mm256_set1_ps(-0.08428509f);
+    p = simde_mm256_add_ps(simde_mm256_mul_ps(p, t), simde_mm256_set1_ps(0.32363037f));
+    p = simde_mm256_add_ps(simde_mm256_mul_ps(p, t), simde_mm256_set1_ps(-0.67808149f));
+    p = simde_mm256_add_ps(simde_mm256_mul_ps(p, t), simde_mm256_set1_ps(1.43854679f));
+    return simde_mm256_add_ps(e, simde_mm256_mul_ps(p, t));
+}
+
+// 20 log10(in[i]), magnitudes under 1e-20 read -400dB
+void magnitudes_to_db(const float * in, float * out, unsigned n)
+{
+    const simde__m256 tiny = simde_mm256_set1_ps(1e-20f);
+    const simde__m256 db_per_octave = simde_mm256_set1_ps(20.0f * std::log10(2.0f));
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 x = simde_mm256_max_ps(simde_mm256_loadu_ps(&in[i]), tiny);
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(fast_log2(x), db_per_octave));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = 20.0f * std::log10(std::max(in[k], 1e-20f));
+    }
+}
+
+// dB is for display only, double magnitudes are narrowed to float first
+void magnitudes_to_db(const double * in, float * out, unsigned n)
+{
+    const simde__m256 tiny = simde_mm256_set1_ps(1e-20f);
+    const simde__m256 db_per_octave = simde_mm256_set1_ps(20.0f * std::log10(2.0f));
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m128 lo = simde_mm256_cvtpd_ps(simde_mm256_loadu_pd(&in[i]));
+        simde__m128 hi = simde_mm256_cvtpd_ps(simde_mm256_loadu_pd(&in[i + 4]));
+        simde__m256 x = simde_mm256_max_ps(simde_mm256_set_m128(hi, lo), tiny);
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(fast_log2(x), db_per_octave));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = 20.0f * std::log10(std::max(static_cast<float>(in[k]), 1e-20f));
+    }
+}
+
+// Analysis engine, T is the sample type: float for the live view, double for measurements
+template <typename T>
 struct Columns {
-    std::vector<float> buffer;
+    std::vector<T> buffer;
     uint32_t window_size;
-    std::vector<float> *window;
+    uint32_t hop_size;
+    const std::vector<T> *window;
     float sampleRate;
 
     struct Column {
-        std::vector<float> bins;
+        std::vector<T> bins;
         std::vector<bool> bins_peak;
-        std::vector<float> bins_phase;
+        std::vector<T> bins_phase;
+        // magnitudes in dB, computed once when the column is pushed
+        std::vector<float> bins_db;
         size_t size;
         bool processed = false;
-        float peakFrequency;
-        float peakMagnitude;
-        int peakBin;
+        float peakFrequency = 0.0f;
+        T peakMagnitude = 0;
+        int peakBin = 0;
+        // filled while Columns::describing is set
+        SpectralDescriptors descriptors;
+        // filled while Columns::harmonics is set
+        HarmonicSeries harmonic;
+        // filled while Columns::deriving is set: instantaneous frequency less the bin centre in
+        // bins, or group delay from the frame centre in samples
+        std::vector<float> bins_deviation;
+        // filled while Columns::lpc_order is set
+        LinearPrediction lpc;
 
         Column(size_t size) {
+            resize(size);
+        }
+
+        void resize(size_t size) {
             bins.resize(size);
             bins_phase.resize(size);
             bins_peak.resize(size);
+            bins_db.resize(size);
             this->size = size;
         }
     };
     std::vector<Column> columns;
 
-    float fct = 2.0f;
+    T fct = 2.0;
+
+    // Multi-resolution: smaller windows analysed over the main frame at their own hop, around its
+    // centre, and stitched by frequency band into the main bin grid.
+    struct Resolution {
+        uint32_t window_size;
+        const std::vector<T> *window;
+        // frames by window_size, all transformed in one call
+        pocketfft::shape_t shape;
+        uint32_t hop;
+        uint32_t frames;
+    };
+    std::vector<Resolution> resolutions;
+    bool multi_resolution = false;
 
-    void init(std::vector<float> *_window, int _window_size)
+    // For each output bin: resolution to read from (0 is the main window), the next
+    // smaller one and the crossfade weight towards it.
+    struct StitchBin {
+        uint8_t res;
+        float crossfade;
+    };
+    std::vector<StitchBin> stitch;
+
+    // A resolution takes over once its window holds this many periods
+    float crossover_cycles = 32.0f;
+
+    // When set, columns hold filterbank bands instead of FFT bins
+    Filterbank *filterbank = nullptr;
+
+    // Multitaper: the main window magnitudes come from the eigenspectra of the frame under the
+    // DPSS tapers for taper_nw, combined by adaptive weighting, instead of the one window. They
+    // are scaled so broadband noise reads as under the window, phases stay the window's.
+    bool multitaper = false;
+    float taper_nw = 4.0f;
+    unsigned adaptive_iterations = 3;
+    const Tapers<T> *tapers = nullptr;
+    T taper_scale = 1;
+
+    // Cepstrum: columns hold the real cepstrum of the main window frame, |IFFT(log |X|)|, bin q
+    // being a quefrency of q samples. Quefrencies under lifter_seconds are faded out so the
+    // spectral envelope doesn't drown echoes and pitch periods, log magnitudes are floored at
+    // cepstrum_floor_db.
+    bool cepstral = false;
+    float lifter_seconds = 0.0f;
+    float cepstrum_floor_db = -120.0f;
+    std::vector<T> lifter;
+
+    // Phase derivatives of every column, single resolution STFT grids only, in order as columns
+    // arrive: instantaneous frequency from the phase advance since the column before, or group
+    // delay from the phase slope across bins. Reassign moves every bin's magnitude to its
+    // instantaneous frequency.
+    PhaseDerivative deriving = kDeriveOff;
+    // advance of every bin centre over a hop, wrapped
+    std::vector<T> phase_advance;
+    std::vector<T> reassign_power;
+
+    // Linear prediction of every main window frame while lpc_order is set (8 to 48), kept in the
+    // column: the autocorrelation of the windowed frame, pre-emphasised by lpc_preemphasis, and the
+    // formants from the envelope peaks between formant_lo and formant_hi narrower than
+    // formant_max_bandwidth. Not for cepstrum, zoom or scalogram.
+    unsigned lpc_order = 0;
+    float lpc_preemphasis = 0.97f;
+    float formant_lo = 150.0f;
+    float formant_hi = 5500.0f;
+    float formant_max_bandwidth = 700.0f;
+    // 2 cos(w) of every bin, where the envelope is evaluated for the formants
+    std::vector<double> lpc_two_cos;
+
+    // Zoom: columns hold the band between zoom_lo and zoom_hi, analysed at window_size
+    // points after decimation
+    ZoomFFT zoom;
+    std::vector<float> zoom_input;
+    bool zoomed = false;
+    float zoom_lo;
+    float zoom_hi;
+
+    // Scalogram: columns hold the Morlet wavelet transform on n_scales log-spaced scales, the
+    // longest wavelet spanning window_size samples, one column every hop_size samples. Scales
+    // are split over the threads of scale_pool when it's set, a pool owned by the caller.
+    MorletCWT cwt;
+    std::vector<float> cwt_input;
+    bool scalogram = false;
+    unsigned n_scales = 128;
+    float wavelet_omega0 = 6.0f;
+    WorkerPool* scale_pool = nullptr;
+
+    // Per-bin averages and holds updated with every pushed column while averaging is set,
+    // with smoothing set the pushed columns hold that trace instead of the raw bins
+    SpectrumTraces<T> traces;
+    bool averaging = false;
+    TraceMode smoothing = kTraceOff;
+    float hold_decay_db = 20.0f;
+
+    // Per-bin noise floor over the last floor_seconds, updated with every pushed column while
+    // flooring is set: Gate clears the bins less than floor_above_db over it, Normalize moves
+    // the floor of every bin to floor_reference_db and leaves the magnitudes alone
+    NoiseFloor noise_floor;
+    FloorMode flooring = kFloorOff;
+    float floor_above_db = 6.0f;
+    float floor_reference_db = -100.0f;
+    float floor_seconds = 1.5f;
+    float floor_smoothing_seconds = 0.05f;
+
+    // Welch PSD of the main window frames, accumulated while psd is set, cleared by init()
+    WelchPSD welch;
+    bool psd = false;
+
+    // Spectral descriptors of every column, computed with the peaks and dB
+    bool describing = false;
+
+    // Harmonic sum of every column over n_harmonics harmonics, plain STFT grids only
+    bool harmonics = false;
+    unsigned n_harmonics = 5;
+    float min_harmonic_frequency = 40.0f;
+
+    // Main window spectrum of every streamed frame, appended while keep_spectra is set and
+    // taken by the caller, for measurements pairing two channels
+    std::vector<std::complex<T>> spectra;
+    bool keep_spectra = false;
+
+    float secondsPerColumn() const
+    {
+        if (zoomed) return static_cast<float>(zoom.hop_size) * zoom.decimation / sampleRate;
+        return hop_size / sampleRate;
+    }
+
+    // Samples fed since the end of the newest column's frame, streaming STFT only
+    size_t pendingSamples() const
+    {
+        return buffer.size() > window_size - hop_size ? buffer.size() - (window_size - hop_size) : 0;
+    }
+
+    size_t outputSize() const
+    {
+        if (zoomed) return zoom.size();
+        if (scalogram) return cwt.size();
+        return filterbank ? filterbank->size() : window_size / 2 + 1;
+    }
+
+    float frequencyAt(size_t bin) const
+    {
+        if (zoomed) return zoom.frequencyAt(bin);
+        if (scalogram) return cwt.frequencyAt(bin);
+        if (filterbank) return filterbank->center_frequencies[bin];
+        // the frequency whose period is the quefrency, bin 0 read as bin 1
+        if (cepstral) return sampleRate / std::max<size_t>(bin, 1);
+        return bin * sampleRate / window_size;
+    }
+
+    // Centre frequencies of the bins when they aren't evenly spaced, nullptr otherwise
+    const std::vector<float>* centerFrequencies() const
+    {
+        if (zoomed) return nullptr;
+        if (scalogram) return &cwt.centers;
+        return filterbank ? &filterbank->center_frequencies : nullptr;
+    }
+
+    // Quefrency of a cepstrum bin, in seconds
+    float quefrencyAt(size_t bin) const
+    {
+        return bin / sampleRate;
+    }
+
+    void init(const std::vector<T> *_window, int _window_size, int _hop_size = 0)
     {
         window = _window;
         window_size = _window_size;
+        hop_size = _hop_size > 0 ? std::min(_hop_size, _window_size) : _window_size;
+        shape[0] = window_size;
         buffer.clear();
+        buffer.reserve(window_size);
+        welch.init(window->data(), window_size);
+        noise_floor.reset();
+        spectra.clear();
+        setMultiResolution(multi_resolution);
+        tapers = multitaper ? &cached_dpss<T>(window_size, taper_nw) : nullptr;
+        T energy = 0;
+        for (T w : *window) energy += w * w;
+        taper_scale = std::sqrt(energy) / (window_size / 2);
+        make_lifter(lifter, window_size / 2 + 1, lifter_seconds * sampleRate);
+        phase_advance.resize(window_size / 2 + 1);
+        for (size_t k = 0; k < phase_advance.size(); k++)
+            phase_advance[k] = principal_arg(2.0 * M_PI * k * hop_size / window_size);
+        lpc_two_cos.resize(window_size / 2 + 1);
+        for (size_t k = 0; k < lpc_two_cos.size(); k++)
+            lpc_two_cos[k] = 2.0 * std::cos(2.0 * M_PI * k / window_size);
+        if (zoomed) zoom.init(sampleRate, zoom_lo, zoom_hi, window_size);
+        if (scalogram) cwt.init(sampleRate, n_scales, window_size, hop_size, wavelet_omega0, scale_pool);
     }
 
-    int feed(float* data, size_t length) {
-        int fed = 0;
-        if (buffer.size() + length < window_size) {
-            buffer.insert(buffer.end(), data, data + length);
-        } else {
-            int available = length;
-            int idx = 0;
-            while ((buffer.size() + available) >= window_size)
+    void setScalogram(bool enabled, unsigned scales = 128)
+    {
+        scalogram = enabled;
+        n_scales = scales;
+        if (scalogram) cwt.init(sampleRate, n_scales, window_size, hop_size, wavelet_omega0, scale_pool);
+    }
+
+    void setZoom(bool enabled, float lo = 0.0f, float hi = 0.0f)
+    {
+        zoomed = enabled;
+        zoom_lo = lo;
+        zoom_hi = hi;
+        if (zoomed) zoom.init(sampleRate, zoom_lo, zoom_hi, window_size);
+    }
+
+    void setMultiResolution(bool enabled)
+    {
+        multi_resolution = enabled;
+        resolutions.clear();
+        stitch.clear();
+        if (!enabled) return;
+
+        for (uint32_t n = window_size / 4; n >= 128 && resolutions.size() < 2; n /= 4)
+        {
+            Resolution r;
+            r.window_size = n;
+            r.window = &cached_hann<T>(n);
+            // half window hops covering the main hop, a single frame when that is shorter
+            r.hop = n / 2;
+            r.frames = std::max<uint32_t>(1, (hop_size + r.hop - 1) / r.hop);
+            r.shape = {r.frames, n};
+            resolutions.push_back(r);
+        }
+
+        // crossover frequencies, with a half octave crossfade on each side
+        const size_t bins = window_size / 2 + 1;
+        const float binWidth = sampleRate / window_size;
+        stitch.resize(bins);
+        for (size_t i = 0; i < bins; i++)
+        {
+            float f = i * binWidth;
+            StitchBin s{0, 0.0f};
+            for (size_t k = 0; k < resolutions.size(); k++)
             {
-                auto eat = window_size - buffer.size();
-                buffer.insert(buffer.end(), data + idx, data + idx + eat);
-                idx += eat;
-                available -= eat;
-                if (buffer.size() == window_size) {
-                    int i;
-                    for (i = 0; i < window_size - window_size % 8; i += 8)
-                    {
-                        simde__m256 buf = simde_mm256_loadu_ps(&buffer[i]);
-                        simde__m256 win = simde_mm256_loadu_ps(&window->data()[i]);
-                        buf = simde_mm256_mul_ps(buf, win);
-                        simde_mm256_storeu_ps(&buffer[i], buf);
-                    }
-                    // non-vectorisable remaining elements
-                    for (int k = i; k < window_size; k++)
-                    {
-                        buffer[k] *= window->data()[k];
-                    }
-                
-                    processFFT();
-                    buffer.clear();
-                    fed++;
+                float fc = crossover_cycles * sampleRate / resolutions[k].window_size;
+                float lo = fc / M_SQRT2;
+                float hi = fc * M_SQRT2;
+                if (f >= hi) {
+                    s.res = k + 1;
+                    s.crossfade = 0.0f;
+                } else {
+                    if (f > lo) s.crossfade = std::log2(f / lo);
+                    break;
                 }
             }
+            stitch[i] = s;
+        }
+    }
+
+    int feed(T* data, size_t length) {
+        if (zoomed) {
+            auto emit = [this]() {
+                Column col(zoom.size());
+                std::copy(zoom.bins.begin(), zoom.bins.end(), col.bins.begin());
+                std::copy(zoom.bins_phase.begin(), zoom.bins_phase.end(), col.bins_phase.begin());
+                pushColumn(col);
+            };
+            // the zoom filter runs in single precision
+            if constexpr (std::is_same_v<T, float>) {
+                return zoom.process(data, length, emit);
+            } else {
+                zoom_input.assign(data, data + length);
+                return zoom.process(zoom_input.data(), length, emit);
+            }
+        }
+        if (scalogram) {
+            auto emit = [this]() {
+                Column col(cwt.size());
+                std::copy(cwt.bins.begin(), cwt.bins.end(), col.bins.begin());
+                std::copy(cwt.bins_phase.begin(), cwt.bins_phase.end(), col.bins_phase.begin());
+                pushColumn(col);
+            };
+            // so does the wavelet transform
+            if constexpr (std::is_same_v<T, float>) {
+                return cwt.process(data, length, emit);
+            } else {
+                cwt_input.assign(data, data + length);
+                return cwt.process(cwt_input.data(), length, emit);
+            }
+        }
+
+        int fed = 0;
+        size_t idx = 0;
+        while (idx < length)
+        {
+            size_t eat = std::min(static_cast<size_t>(window_size - buffer.size()), length - idx);
+            buffer.insert(buffer.end(), data + idx, data + idx + eat);
+            idx += eat;
+            if (buffer.size() == window_size) {
+                Column col(outputSize());
+                computeColumn(buffer.data(), col, stream);
+                if (psd) welch.accumulate(stream.spectrum.data(), stream.spectrum.size());
+                if (keep_spectra) spectra.insert(spectra.end(), stream.spectrum.begin(), stream.spectrum.end());
+                pushColumn(col);
+                buffer.erase(buffer.begin(), buffer.begin() + hop_size);
+                fed++;
+            }
         }
         return fed;
     }
 
-    std::vector<std::complex<float>> fftOutput;
-    pocketfft::shape_t shape{window_size};
-    pocketfft::stride_t stride_in{sizeof(float)}; 
-    pocketfft::stride_t stride_out{sizeof(std::complex<float>)}; 
+    // Working buffers of one analysis, callers running concurrently each bring their own
+    struct Scratch {
+        std::vector<T> frame;
+        std::vector<std::complex<T>> spectrum;
+        Column full{0};
+        std::vector<std::vector<T>> res_frame;
+        std::vector<std::vector<std::complex<T>>> res_output;
+        std::vector<std::vector<T>> res_power;
+        std::vector<T> taper_frames;
+        std::vector<std::complex<T>> taper_spectra;
+        std::vector<T> taper_magnitudes;
+        std::vector<float> log_db;
+        std::vector<std::complex<T>> log_spectrum;
+        std::vector<T> cepstrum;
+        std::vector<double> lpc_magnitudes;
+        std::vector<float> lpc_db;
+    };
+    Scratch stream;
+
+    pocketfft::shape_t shape{0};
+    pocketfft::stride_t stride_in{sizeof(T)}; 
+    pocketfft::stride_t stride_out{sizeof(std::complex<T>)}; 
+
+    void prepare(Scratch& s) const
+    {
+        s.frame.resize(window_size);
+        s.spectrum.resize(window_size / 2 + 1);
+        if (tapers) {
+            s.taper_frames.resize(tapers->windows.size());
+            s.taper_spectra.resize(tapers->count * (window_size / 2 + 1));
+            s.taper_magnitudes.resize(tapers->count * (window_size / 2 + 1));
+        }
+        s.log_db.resize(window_size / 2 + 1);
+        s.log_spectrum.resize(window_size / 2 + 1);
+        s.cepstrum.resize(window_size);
+        s.lpc_magnitudes.resize(window_size / 2 + 1);
+        s.lpc_db.resize(window_size / 2 + 1);
+        s.res_frame.resize(resolutions.size());
+        s.res_output.resize(resolutions.size());
+        s.res_power.resize(resolutions.size());
+        for (size_t k = 0; k < resolutions.size(); k++)
+        {
+            const Resolution& r = resolutions[k];
+            s.res_frame[k].resize(r.frames * r.window_size);
+            s.res_output[k].resize(r.frames * (r.window_size / 2 + 1));
+            s.res_power[k].resize(r.window_size / 2 + 1);
+        }
+    }
+
+    bool resolutionsPrepared(const Scratch& s) const
+    {
+        if (s.res_frame.size() != resolutions.size()) return false;
+        for (size_t k = 0; k < resolutions.size(); k++)
+            if (s.res_frame[k].size() != resolutions[k].frames * resolutions[k].window_size) return false;
+        return true;
+    }
+
+    // The smaller windows step through the main hop around the frame centre at their own hop, so
+    // consecutive columns cover the whole signal, and their power is averaged over those frames
+    void processResolutions(const T* data, Scratch& s) const
+    {
+        for (size_t k = 0; k < resolutions.size(); k++)
+        {
+            const Resolution& r = resolutions[k];
+            const size_t bins = r.window_size / 2 + 1;
+            const double first = window_size / 2.0 - (r.frames - 1) * r.hop / 2.0 - r.window_size / 2.0;
+            for (uint32_t j = 0; j < r.frames; j++)
+            {
+                const long start = std::clamp<long>(std::lround(first + j * r.hop), 0, window_size - r.window_size);
+                apply_window(data + start, r.window->data(), s.res_frame[k].data() + j * r.window_size, r.window_size);
+            }
+            pocketfft::r2c(
+                r.shape,
+                pocketfft::stride_t{static_cast<ptrdiff_t>(r.window_size * sizeof(T)), sizeof(T)},
+                pocketfft::stride_t{static_cast<ptrdiff_t>(bins * sizeof(std::complex<T>)), sizeof(std::complex<T>)},
+                1,
+                pocketfft::FORWARD,
+                s.res_frame[k].data(),
+                s.res_output[k].data(),
+                fct
+            );
+            std::vector<T>& power = s.res_power[k];
+            std::fill(power.begin(), power.end(), T(0));
+            for (uint32_t j = 0; j < r.frames; j++)
+            {
+                const std::complex<T>* out = s.res_output[k].data() + j * bins;
+                for (size_t b = 0; b < bins; b++) power[b] += std::norm(out[b]);
+            }
+            for (size_t b = 0; b < bins; b++) power[b] /= r.frames;
+        }
+    }
+
+    // Magnitude and phase of resolution `res` at main-grid bin `i`, linearly interpolated, the
+    // phase from the frame at the centre
+    void resolutionAt(const Scratch& s, size_t res, size_t i, T& magnitude, T& phase) const
+    {
+        const Resolution& r = resolutions[res - 1];
+        const auto& power = s.res_power[res - 1];
+        const std::complex<T>* centre = s.res_output[res - 1].data() + (r.frames / 2) * power.size();
+        T at = static_cast<T>(i) * r.window_size / window_size;
+        size_t lo = std::min(static_cast<size_t>(at), power.size() - 2);
+        T t = at - lo;
+        T norm = r.window_size / 2;
+        magnitude = (std::sqrt(power[lo]) * (1 - t) + std::sqrt(power[lo + 1]) * t) / norm;
+        phase = std::arg(centre[t < 0.5f ? lo : lo + 1]);
+    }
+
+    void stitchResolutions(const T* data, Column& col, Scratch& s) const
+    {
+        processResolutions(data, s);
+        for (size_t i = 0; i < col.size; i++)
+        {
+            const StitchBin& st = stitch[i];
+            T mag_a = col.bins[i], phase_a = col.bins_phase[i];
+            if (st.res > 0) resolutionAt(s, st.res, i, mag_a, phase_a);
+            if (st.crossfade > 0.0f) {
+                T mag_b, phase_b;
+                resolutionAt(s, st.res + 1, i, mag_b, phase_b);
+                mag_a = mag_a * (1 - st.crossfade) + mag_b * st.crossfade;
+                if (st.crossfade > 0.5f) phase_a = phase_b;
+            }
+            col.bins[i] = mag_a;
+            col.bins_phase[i] = phase_a;
+        }
+    }
+
+    // Eigenspectra of the frame under every taper in one batched transform, combined into the bins
+    void multitaperMagnitudes(const T* data, Column& col, Scratch& s) const
+    {
+        const size_t k = tapers->count;
+        const size_t bins = window_size / 2 + 1;
+        for (size_t t = 0; t < k; t++)
+            apply_window(data, tapers->windows.data() + t * window_size, s.taper_frames.data() + t * window_size, window_size);
+        pocketfft::r2c(
+            pocketfft::shape_t{k, window_size},
+            pocketfft::stride_t{static_cast<ptrdiff_t>(window_size * sizeof(T)), sizeof(T)},
+            pocketfft::stride_t{static_cast<ptrdiff_t>(bins * sizeof(std::complex<T>)), sizeof(std::complex<T>)},
+            1,
+            pocketfft::FORWARD,
+            s.taper_frames.data(),
+            s.taper_spectra.data(),
+            fct
+        );
+        complex_magnitudes(s.taper_spectra.data(), s.taper_magnitudes.data(), k * bins, taper_scale);
+
+        // the power a unit energy taper gets from white noise of the frame's variance
+        T variance = 0;
+        for (size_t j = 0; j < window_size; j++) variance += data[j] * data[j];
+        variance *= fct * fct * taper_scale * taper_scale / window_size;
+        adaptive_multitaper(s.taper_magnitudes.data(), tapers->ratios.data(), k, bins, variance, adaptive_iterations, col.bins.data());
+    }
 
-    void processFFT() {
-        shape[0] = buffer.size();
-        fftOutput.clear();
-        fftOutput.resize(window_size / 2 + 1);
+    // Bins of the window_size samples at data, col is resized to outputSize() when needed.
+    // Only reads the settings, so it's safe to call concurrently with separate scratch.
+    void computeColumn(const T* data, Column& col, Scratch& s) const
+    {
+        if (s.frame.size() != window_size || !resolutionsPrepared(s)
+            || (tapers && s.taper_frames.size() != tapers->windows.size())) prepare(s);
+        apply_window(data, window->data(), s.frame.data(), window_size);
         pocketfft::r2c(
             shape,
             stride_in,
             stride_out,
             0,
             pocketfft::FORWARD,
-            buffer.data(),
-            reinterpret_cast<std::complex<float>*>(fftOutput.data()),
+            s.frame.data(),
+            s.spectrum.data(),
             fct
         );
 
-        Column col(fftOutput.size());
+        // the filterbank reads from the full resolution bins
+        Column& full = filterbank ? s.full : col;
+        if (full.size != s.spectrum.size()) full.resize(s.spectrum.size());
+        complex_magnitudes(s.spectrum.data(), full.bins.data(), s.spectrum.size(), T(1) / (window_size / 2));
+        for (size_t i = 0; i < s.spectrum.size(); ++i) {
+            full.bins_phase[i] = std::arg(s.spectrum[i]);
+        }
+        if (tapers) multitaperMagnitudes(data, full, s);
+        else if (!resolutions.empty()) stitchResolutions(data, full, s);
+        if (lpc_order > 0 && !cepstral) computeLPC(col, s);
+        else col.lpc = LinearPrediction();
+
+        if (filterbank) {
+            if (col.size != filterbank->size()) col.resize(filterbank->size());
+            filterbank->apply(full.bins.data(), col.bins.data());
+            std::fill(col.bins_phase.begin(), col.bins_phase.end(), T(0));
+        }
+        if (cepstral) computeCepstrum(col, s);
+    }
+
+    // Real cepstrum of the bins of col, in place. The inverse transform has the length of the
+    // forward one, so it runs on the plan already cached for it.
+    void computeCepstrum(Column& col, Scratch& s) const
+    {
+        magnitudes_to_db(col.bins.data(), s.log_db.data(), col.size);
+        db_to_log_spectrum(s.log_db.data(), s.log_spectrum.data(), col.size, cepstrum_floor_db);
+        pocketfft::c2r(
+            shape,
+            stride_out,
+            stride_in,
+            0,
+            pocketfft::BACKWARD,
+            s.log_spectrum.data(),
+            s.cepstrum.data(),
+            T(1) / window_size
+        );
+        lifter_magnitudes(s.cepstrum.data(), lifter.data(), col.bins.data(), col.size);
+        std::fill(col.bins_phase.begin(), col.bins_phase.end(), T(0));
+    }
+
+    // Linear prediction of the windowed frame in s.frame. Only the order + 2 lags the model needs
+    // are correlated, and |A| is evaluated on the bins between the formant limits alone, so no
+    // transform runs beyond the column's own.
+    void computeLPC(Column& col, Scratch& s) const
+    {
+        LinearPrediction& lp = col.lpc;
+        const size_t bins = s.spectrum.size();
+        const unsigned order = std::min<unsigned>({ lpc_order, LinearPrediction::max_order, window_size - 1 });
+        double acf[LinearPrediction::max_order + 2], r[LinearPrediction::max_order + 1], a[LinearPrediction::max_order + 1];
+        autocorrelation(s.frame.data(), window_size, order + 1, acf);
+        // y[n] = x[n] - mu x[n - 1] correlates to (1 + mu^2) r[k] - mu (r[k - 1] + r[k + 1]), on the
+        // scale of the bins before their 1 / (N / 2)
+        const double mu = lpc_preemphasis;
+        for (unsigned k = 0; k <= order; k++)
+            r[k] = fct * fct * ((1.0 + mu * mu) * acf[k] - mu * (acf[k == 0 ? 1 : k - 1] + acf[k + 1]));
+        const double error = levinson_durbin(r, order, a);
+        if (!(error > 0.0)) {
+            lp = LinearPrediction();
+            return;
+        }
+        lp.order = order;
+        std::copy(a, a + order + 1, lp.coefficients);
+        // the model's power is on the scale of |X|^2, the bins are |X| / (N / 2)
+        lp.gain_db = 10.0 * std::log10(error) - 20.0 * std::log10(window_size / 2.0);
+        lp.preemphasis = lpc_preemphasis;
+
+        // find_formants() reads from the bin under formant_lo to the one at formant_hi
+        const float df = sampleRate / window_size;
+        const unsigned first = std::max(1, static_cast<int>(std::ceil(formant_lo / df))) - 1;
+        const unsigned last = std::min<unsigned>(bins - 1, formant_hi / df);
+        if (last > first) {
+            lpc_inverse_magnitudes(lp, &lpc_two_cos[first], &s.lpc_magnitudes[first], last - first + 1);
+            magnitudes_to_db(&s.lpc_magnitudes[first], &s.lpc_db[first], last - first + 1);
+        }
+        find_formants(s.lpc_db.data(), bins, df, formant_lo, formant_hi, formant_max_bandwidth, lp);
+    }
+
+    // Peaks and dB of a column whose bins are final
+    void finishColumn(Column& col) const
+    {
         int peakIndex = 0;
-        float peakMag = 0;
-        for (size_t i = 0; i < fftOutput.size(); ++i) {
-            float magnitude = std::abs(fftOutput[i]) / (window_size / 2);
+        T peakMag = 0;
+        for (size_t i = 0; i < col.size; ++i) {
+            T magnitude = col.bins[i];
             if (magnitude > peakMag) { peakMag = magnitude; peakIndex = i; }
-            col.bins[i] = magnitude;
-            col.bins_phase[i] = std::arg(fftOutput[i]);
             if (i > 1) {
                 if ((col.bins[i-1] > col.bins[i]) && (col.bins[i-1] > col.bins[i-2]))
                 {
@@ -143,9 +804,130 @@ struct Columns {
                 }
             }
         }
-        col.peakFrequency = peakIndex * (sampleRate / (fftOutput.size() - 1) / 2);
+        col.peakFrequency = frequencyAt(peakIndex);
         col.peakBin = peakIndex;
         col.peakMagnitude = peakMag;
+        magnitudes_to_db(col.bins.data(), col.bins_db.data(), col.size);
+        if (describing) describe(col);
+        if (harmonics) findHarmonics(col);
+    }
+
+    // a harmonic series is only evenly spaced in bins on a grid starting at 0 Hz
+    void findHarmonics(Column& col) const
+    {
+        if (filterbank || zoomed || cepstral || scalogram) {
+            col.harmonic = HarmonicSeries();
+            return;
+        }
+        find_harmonics(col.bins_db.data(), col.bins_peak, col.size, frequencyAt(1), min_harmonic_frequency, n_harmonics, col.harmonic);
+    }
+
+    void describe(Column& col) const
+    {
+        const std::vector<float>* centers = centerFrequencies();
+        const float* freqs = centers ? centers->data() : nullptr;
+        const float f0 = frequencyAt(0);
+        const float df = col.size > 1 ? frequencyAt(1) - f0 : 0.0f;
+        // flux belongs to the pair of columns, it survives the bins being finished again
+        const float flux = col.descriptors.flux;
+        // quefrency bins have no frequency grid to describe, only the flux makes sense
+        if (cepstral) col.descriptors = SpectralDescriptors();
+        else describe_spectrum(col.bins.data(), col.bins_db.data(), freqs, f0, df, col.size, col.descriptors);
+        col.descriptors.flux = flux;
+    }
+
+    // Flux against the column before, once both are final
+    void describeFlux(Column& col, const Column& previous) const
+    {
+        col.descriptors.flux = previous.size == col.size ? spectral_flux(col.bins.data(), previous.bins.data(), col.size) : 0.0f;
+    }
+
+    bool derivable() const
+    {
+        return deriving != kDeriveOff && !filterbank && !zoomed && !cepstral && !scalogram && resolutions.empty();
+    }
+
+    // Deviations of col against the column before it, nullptr for none, both with the raw bins of
+    // computeColumn. Reassign moves the magnitudes, so the bins have to be finished after.
+    void derivePhase(Column& col, const Column* previous)
+    {
+        if (!derivable()) {
+            col.bins_deviation.clear();
+            return;
+        }
+        col.bins_deviation.resize(col.size);
+        if (deriving == kDeriveDelay) {
+            group_delay(col.bins_phase.data(), col.bins_deviation.data(), col.size, -(window_size / (4 * M_PI)));
+            return;
+        }
+        if (previous && previous->processed && previous->size == col.size)
+            instantaneous_frequency(col.bins_phase.data(), previous->bins_phase.data(), phase_advance.data(),
+                                    col.bins_deviation.data(), col.size, window_size / (2 * M_PI * hop_size));
+        else
+            std::fill(col.bins_deviation.begin(), col.bins_deviation.end(), 0.0f);
+        if (deriving == kDeriveReassign) {
+            reassign_power.resize(col.size);
+            reassign_frequency(col.bins.data(), col.bins_deviation.data(), reassign_power.data(), col.size);
+        }
+    }
+
+    // Derivatives of a column analysed outside the stream, once the one before it is final
+    void deriveAnalysed(Column& col, const Column* previous)
+    {
+        derivePhase(col, previous);
+        if (deriving == kDeriveReassign && derivable()) finishColumn(col);
+    }
+
+    // Complete analysis of one frame outside the stream, traces and PSD are left alone and
+    // marking the column processed is up to the caller
+    void analyze(const T* data, Column& col, Scratch& s) const
+    {
+        computeColumn(data, col, s);
+        finishColumn(col);
+    }
+
+    // The floor is a stream: columns go through it in order, after their dB
+    void applyFloor(Column& col)
+    {
+        if (noise_floor.size != col.size) {
+            // the scalogram's frames are as long as the wavelet of its middle scale
+            const float frame_seconds = scalogram ? cwt.frameSeconds(cwt.size() / 2)
+                                                  : window_size * (zoomed ? zoom.decimation : 1) / sampleRate;
+            noise_floor.setup(secondsPerColumn(), frame_seconds, floor_seconds, floor_smoothing_seconds);
+        }
+        noise_floor.update(col.bins_db.data(), col.size);
+        if (flooring == kFloorGate)
+            gate_to_floor(col.bins_db.data(), col.bins.data(), noise_floor.floor.data(), col.size, floor_above_db, -400.0f);
+        else
+            normalize_to_floor(col.bins_db.data(), noise_floor.floor.data(), col.size, floor_reference_db);
+    }
+
+    // Floor from scratch over columns analysed outside the stream, oldest first
+    void applyFloorAll()
+    {
+        noise_floor.reset();
+        for (Column& col : columns)
+        {
+            if (col.processed) applyFloor(col);
+        }
+    }
+
+    void pushColumn(Column& col)
+    {
+        if (deriving != kDeriveOff) derivePhase(col, columns.empty() ? nullptr : &columns.back());
+        if (averaging || smoothing != kTraceOff) {
+            // hold decay is given in dB per second
+            traces.decay = std::pow(T(10), -hold_decay_db * secondsPerColumn() / 20);
+            traces.update(col.bins.data(), col.size);
+            if (smoothing != kTraceOff) {
+                const std::vector<T>& smoothed = *traces.trace(smoothing);
+                std::copy(smoothed.begin(), smoothed.end(), col.bins.begin());
+            }
+        }
+        finishColumn(col);
+        if (flooring != kFloorOff) applyFloor(col);
+        if (describing && !columns.empty()) describeFlux(col, columns.back());
+        col.processed = true;
 
         // columns_memory_size accounts for some excedent, half of the columns_memory_size oldest columns get removed
         if (columns.size() > columns_memory_size ) {
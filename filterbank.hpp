@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "SimdUtils.hpp"
+
+// Perceptual frequency scales, forward and inverse
+// Bark: Traunmüller 1990, ERB-rate: Glasberg & Moore 1990
+enum FilterbankScale {
+    kScaleMel = 0,
+    kScaleBark,
+    kScaleERB,
+};
+
+inline float hz_to_scale(FilterbankScale scale, float f)
+{
+    switch (scale) {
+        case kScaleMel:  return 2595.0f * std::log10(1.0f + f / 700.0f);
+        case kScaleBark: return 26.81f * f / (1960.0f + f) - 0.53f;
+        case kScaleERB:  return 21.4f * std::log10(1.0f + 0.00437f * f);
+    }
+    return f;
+}
+
+inline float scale_to_hz(FilterbankScale scale, float z)
+{
+    switch (scale) {
+        case kScaleMel:  return 700.0f * (std::pow(10.0f, z / 2595.0f) - 1.0f);
+        case kScaleBark: return 1960.0f * (z + 0.53f) / (26.28f - z);
+        case kScaleERB:  return (std::pow(10.0f, z / 21.4f) - 1.0f) / 0.00437f;
+    }
+    return z;
+}
+
+// Triangular filterbank over FFT magnitude bins, stored sparse: each band keeps its first
+// bin and an offset into a packed weights array, so applying it only touches non-zero weights.
+struct Filterbank {
+    struct Band {
+        uint32_t start;
+        uint32_t offset;
+        uint32_t length;
+    };
+    std::vector<Band> bands;
+    std::vector<float> weights;
+    std::vector<double> weights_d;
+    std::vector<float> center_frequencies;
+    FilterbankScale scale = kScaleMel;
+
+    size_t size() const { return bands.size(); }
+
+    void init(FilterbankScale _scale, int n_bands, int window_size, float sampleRate, float fmin = 20.0f, float fmax = 0.0f)
+    {
+        scale = _scale;
+        const int n_bins = window_size / 2 + 1;
+        const float binWidth = sampleRate / window_size;
+        if (fmax <= 0.0f || fmax > sampleRate / 2) fmax = sampleRate / 2;
+
+        // n_bands + 2 edges equally spaced on the perceptual scale
+        std::vector<float> edges(n_bands + 2);
+        const float zmin = hz_to_scale(scale, fmin);
+        const float zmax = hz_to_scale(scale, fmax);
+        for (int k = 0; k < n_bands + 2; k++)
+        {
+            edges[k] = scale_to_hz(scale, zmin + (zmax - zmin) * k / (n_bands + 1));
+        }
+
+        bands.resize(n_bands);
+        center_frequencies.resize(n_bands);
+        weights.clear();
+        for (int k = 0; k < n_bands; k++)
+        {
+            const float lo = edges[k], mid = edges[k + 1], hi = edges[k + 2];
+            int first = std::max(0, static_cast<int>(std::ceil(lo / binWidth)));
+            int last = std::min(n_bins - 1, static_cast<int>(std::floor(hi / binWidth)));
+
+            Band& b = bands[k];
+            b.offset = weights.size();
+            if (last < first) {
+                // band narrower than a bin: take the nearest bin
+                b.start = std::min(n_bins - 1, static_cast<int>(std::lround(mid / binWidth)));
+                b.length = 1;
+                weights.push_back(1.0f);
+            } else {
+                b.start = first;
+                b.length = last - first + 1;
+                for (int i = first; i <= last; i++)
+                {
+                    const float f = i * binWidth;
+                    weights.push_back(f <= mid ? (f - lo) / (mid - lo) : (hi - f) / (hi - mid));
+                }
+            }
+            center_frequencies[k] = mid;
+        }
+        weights_d.assign(weights.begin(), weights.end());
+    }
+
+    void apply(const float* magnitudes, float* out) const
+    {
+        for (size_t k = 0; k < bands.size(); k++)
+        {
+            const Band& b = bands[k];
+            out[k] = simd_buffer_dot(&weights[b.offset], &magnitudes[b.start], b.length);
+        }
+    }
+
+    void apply(const double* magnitudes, double* out) const
+    {
+        for (size_t k = 0; k < bands.size(); k++)
+        {
+            const Band& b = bands[k];
+            out[k] = simd_buffer_dot(&weights_d[b.offset], &magnitudes[b.start], b.length);
+        }
+    }
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "pocketfft_cached.hpp"
+#include "simde/x86/avx2.h"
+#include "transfer.hpp"
+
+// Cross spectrum with phase transform: conj(x) y / |conj(x) y| two bins at a time,
+// bins where either side is silent add nothing
+static inline simde__m256d phat_pair(simde__m256d a, simde__m256d b)
+{
+    simde__m256d c = conj_mul_pd(a, b);
+    // |c|^2 of each bin in both of its lanes
+    simde__m256d sq = simde_mm256_mul_pd(c, c);
+    simde__m256d norm = simde_mm256_sqrt_pd(simde_mm256_hadd_pd(sq, sq));
+    simde__m256d nonzero = simde_mm256_cmp_pd(norm, simde_mm256_set1_pd(1e-30), SIMDE_CMP_GT_OQ);
+    return simde_mm256_and_pd(simde_mm256_div_pd(c, simde_mm256_max_pd(norm, simde_mm256_set1_pd(1e-30))), nonzero);
+}
+
+void accumulate_phat(const std::complex<float> * x, const std::complex<float> * y, std::complex<double> * acc, unsigned n, double decay)
+{
+    const float * fx = reinterpret_cast<const float *>(x);
+    const float * fy = reinterpret_cast<const float *>(y);
+    double * g = reinterpret_cast<double *>(acc);
+    const simde__m256d d = simde_mm256_set1_pd(decay);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256 a = simde_mm256_loadu_ps(&fx[2 * i]);
+        simde__m256 b = simde_mm256_loadu_ps(&fy[2 * i]);
+        simde__m256d lo = phat_pair(simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(a)), simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(b)));
+        simde__m256d hi = phat_pair(simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(a, 1)), simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(b, 1)));
+        simde_mm256_storeu_pd(&g[2 * i], simde_mm256_add_pd(simde_mm256_mul_pd(simde_mm256_loadu_pd(&g[2 * i]), d), lo));
+        simde_mm256_storeu_pd(&g[2 * i + 4], simde_mm256_add_pd(simde_mm256_mul_pd(simde_mm256_loadu_pd(&g[2 * i + 4]), d), hi));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        const std::complex<double> c = std::conj(std::complex<double>(x[k])) * std::complex<double>(y[k]);
+        const double norm = std::abs(c);
+        acc[k] = acc[k] * decay + (norm > 1e-30 ? c / norm : std::complex<double>(0.0));
+    }
+}
+
+void accumulate_phat(const std::complex<double> * x, const std::complex<double> * y, std::complex<double> * acc, unsigned n, double decay)
+{
+    const double * dx = reinterpret_cast<const double *>(x);
+    const double * dy = reinterpret_cast<const double *>(y);
+    double * g = reinterpret_cast<double *>(acc);
+    const simde__m256d d = simde_mm256_set1_pd(decay);
+    unsigned i;
+    for (i = 0; i < n - n % 2; i += 2)
+    {
+        simde__m256d c = phat_pair(simde_mm256_loadu_pd(&dx[2 * i]), simde_mm256_loadu_pd(&dy[2 * i]));
+        simde_mm256_storeu_pd(&g[2 * i], simde_mm256_add_pd(simde_mm256_mul_pd(simde_mm256_loadu_pd(&g[2 * i]), d), c));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        const std::complex<double> c = std::conj(x[k]) * y[k];
+        const double norm = std::abs(c);
+        acc[k] = acc[k] * decay + (norm > 1e-30 ? c / norm : std::complex<double>(0.0));
+    }
+}
+
+// Delay of y against x by generalized cross-correlation with phase transform. The whitened
+// cross spectra of the frames are averaged, one inverse FFT gives the correlation whose peak
+// is the whole sample lag, the phase slope gives the rest. A pure delay correlates to 1,
+// uncorrelated inputs to ~0.
+struct DelayEstimator {
+    std::vector<std::complex<double>> phat;
+    std::vector<double> correlation;
+    uint32_t window_size = 0;
+    uint64_t frames = 0;
+    // sum of the frame weights, frames for a plain average
+    double weight = 0.0;
+    double decay = 1.0;
+
+    void init(uint32_t _window_size)
+    {
+        window_size = _window_size;
+        phat.resize(window_size / 2 + 1);
+        correlation.resize(window_size);
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(phat.begin(), phat.end(), std::complex<double>(0.0));
+        frames = 0;
+        weight = 0.0;
+    }
+
+    // 0 averages everything, otherwise same equivalent length as the exponential trace
+    void setFrames(uint32_t n)
+    {
+        decay = n == 0 ? 1.0 : 1.0 - 2.0 / (n + 1);
+    }
+
+    size_t size() const { return phat.size(); }
+
+    template <typename T>
+    void accumulate(const std::complex<T>* x, const std::complex<T>* y)
+    {
+        accumulate_phat(x, y, phat.data(), size(), decay);
+        weight = weight * decay + 1.0;
+        frames++;
+    }
+
+    // Lag in samples, positive when y comes after x, and the height of the correlation peak.
+    // Lags are within +-window_size / 2, false until a frame was accumulated.
+    bool estimate(double& delay, double& confidence)
+    {
+        if (frames == 0 || window_size < 4) return false;
+        pocketfft::c2r(
+            pocketfft::shape_t{window_size},
+            pocketfft::stride_t{sizeof(std::complex<double>)},
+            pocketfft::stride_t{sizeof(double)},
+            0,
+            pocketfft::BACKWARD,
+            phat.data(),
+            correlation.data(),
+            1.0 / (weight * window_size)
+        );
+
+        const size_t peak = std::max_element(correlation.begin(), correlation.end()) - correlation.begin();
+        const double lag = peak > window_size / 2 ? static_cast<double>(peak) - window_size : static_cast<double>(peak);
+
+        // what's left is under a sample, the phase of the cross spectrum once the whole lag is
+        // taken out is a line through 0 that stays within +-pi/2: fitted weighted by magnitude
+        double num = 0.0, den = 0.0;
+        for (size_t k = 1; k < phat.size(); k++)
+        {
+            const double w = 2 * M_PI * k / window_size;
+            const std::complex<double> c = phat[k] * std::polar(1.0, w * lag);
+            const double m = std::abs(c);
+            num += m * w * std::arg(c);
+            den += m * w * w;
+        }
+        const double offset = den > 0.0 ? std::clamp(-num / den, -1.0, 1.0) : 0.0;
+
+        // peak height interpolated with a parabola
+        const double y0 = correlation[(peak + window_size - 1) % window_size];
+        const double y1 = correlation[peak];
+        const double y2 = correlation[(peak + 1) % window_size];
+        const double t = std::clamp(offset, -0.5, 0.5);
+        delay = lag + offset;
+        confidence = std::clamp(y1 + 0.5 * t * (y2 - y0) + 0.5 * t * t * (y0 - 2.0 * y1 + y2), 0.0, 1.0);
+        return true;
+    }
+};
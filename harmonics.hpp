@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+// Fundamental of a column from its harmonic sum and the peaks of the series it matched
+struct HarmonicSeries {
+    static constexpr unsigned max_harmonics = 8;
+    float f0 = 0.0f;       // Hz, 0 when no harmonic peak was found
+    float salience = 0.0f; // mean level of the harmonics above the column's mean, dB
+    // peak bin of harmonic h at bins[h - 1], -1 where there is none
+    int32_t bins[max_harmonics];
+
+    HarmonicSeries() { std::fill(bins, bins + max_harmonics, -1); }
+};
+
+// Harmonic sum of 8 candidate fundamentals at once. Harmonic h of a fundamental between bins
+// k and k + 1 lands in [h k, h k + h), the loudest bin there counts, never below `floor`.
+// Summing dB is the log of the harmonic product spectrum.
+static inline simde__m256 harmonic_sum_ps(const float * db, simde__m256i k, unsigned harmonics, simde__m256 floor)
+{
+    simde__m256 sum = simde_mm256_setzero_ps();
+    for (unsigned h = 1; h <= harmonics; h++)
+    {
+        const simde__m256i base = simde_mm256_mullo_epi32(k, simde_mm256_set1_epi32(h));
+        simde__m256 loudest = floor;
+        for (unsigned j = 0; j < h; j++)
+        {
+            const simde__m256i at = simde_mm256_add_epi32(base, simde_mm256_set1_epi32(j));
+            loudest = simde_mm256_max_ps(loudest, simde_mm256_i32gather_ps(db, at, 4));
+        }
+        sum = simde_mm256_add_ps(sum, loudest);
+    }
+    return sum;
+}
+
+static inline float harmonic_sum_at(const float * db, unsigned k, unsigned harmonics, float floor)
+{
+    float sum = 0.0f;
+    for (unsigned h = 1; h <= harmonics; h++)
+        sum += std::max(floor, *std::max_element(db + h * k, db + h * k + h));
+    return sum;
+}
+
+// Candidate fundamental bin in [k_lo, k_hi) with the largest harmonic sum, k_hi at most
+// n / harmonics so the highest harmonic stays within the column
+unsigned harmonic_sum_peak(const float * db, unsigned k_lo, unsigned k_hi, unsigned harmonics, float floor, float& best)
+{
+    const simde__m256 fl = simde_mm256_set1_ps(floor);
+    simde__m256 best_v = simde_mm256_set1_ps(-INFINITY);
+    simde__m256i best_k = simde_mm256_setzero_si256();
+    simde__m256i k = simde_mm256_add_epi32(simde_mm256_set1_epi32(k_lo), simde_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const simde__m256i eight = simde_mm256_set1_epi32(8);
+    const unsigned n = k_hi - k_lo;
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 sum = harmonic_sum_ps(db, k, harmonics, fl);
+        simde__m256 better = simde_mm256_cmp_ps(sum, best_v, SIMDE_CMP_GT_OQ);
+        best_v = simde_mm256_blendv_ps(best_v, sum, better);
+        best_k = simde_mm256_castps_si256(simde_mm256_blendv_ps(simde_mm256_castsi256_ps(best_k), simde_mm256_castsi256_ps(k), better));
+        k = simde_mm256_add_epi32(k, eight);
+    }
+    float values[8];
+    int32_t bins[8];
+    simde_mm256_storeu_ps(values, best_v);
+    simde_mm256_storeu_si256(reinterpret_cast<simde__m256i *>(bins), best_k);
+    unsigned peak = k_lo;
+    best = -INFINITY;
+    for (unsigned lane = 0; lane < 8 && i > 0; lane++)
+    {
+        // the lowest bin wins a tie, like the scalar scan
+        if (values[lane] > best || (values[lane] == best && static_cast<unsigned>(bins[lane]) < peak))
+        {
+            best = values[lane];
+            peak = bins[lane];
+        }
+    }
+    // non-vectorisable remaining elements
+    for (unsigned c = k_lo + i; c < k_hi; c++)
+    {
+        const float sum = harmonic_sum_at(db, c, harmonics, floor);
+        if (sum > best)
+        {
+            best = sum;
+            peak = c;
+        }
+    }
+    return peak;
+}
+
+// Harmonic sum over a column of dB magnitudes on a grid starting at 0 Hz with bins df apart.
+// Levels more than floor_range dB under the loudest bin all count the same. A candidate an
+// octave down that sums within octave_db per harmonic of the best one wins, so a weak or missing
+// fundamental isn't reported as its second harmonic. The f0 is then refined from the peaks
+// found near each harmonic (bins_peak of the column) at least peak_db over the column's mean,
+// least squares through 0 Hz.
+void find_harmonics(const float * db, const std::vector<bool>& peaks, unsigned n, float df, float min_frequency,
+                    unsigned harmonics, HarmonicSeries& out)
+{
+    static constexpr float floor_range = 80.0f;
+    static constexpr float octave_db = 6.0f;
+    static constexpr float peak_db = 10.0f;
+    out = HarmonicSeries();
+    harmonics = std::clamp(harmonics, 1u, HarmonicSeries::max_harmonics);
+    if (df <= 0.0f || n < 2 * harmonics) return;
+
+    const float loudest = *std::max_element(db, db + n);
+    const float floor = loudest - floor_range;
+    double mean = 0.0;
+    for (unsigned i = 0; i < n; i++) mean += std::max(db[i], floor);
+    mean /= n;
+
+    const unsigned k_lo = std::max(1u, static_cast<unsigned>(std::ceil(min_frequency / df)));
+    const unsigned k_hi = n / harmonics;
+    if (k_lo >= k_hi) return;
+
+    float best;
+    unsigned k = harmonic_sum_peak(db, k_lo, k_hi, harmonics, floor, best);
+    if (k / 2 >= k_lo)
+    {
+        const float below = harmonic_sum_at(db, k / 2, harmonics, floor);
+        if (below >= best - octave_db * harmonics)
+        {
+            k /= 2;
+            best = below;
+        }
+    }
+
+    double num = 0.0, den = 0.0;
+    for (unsigned h = 1; h <= harmonics; h++)
+    {
+        // one bin of slack either side for peaks right at the edge of the range
+        const unsigned lo = h * k > 0 ? h * k - 1 : 0;
+        const unsigned hi = std::min(n - 1, h * k + h + 1);
+        int32_t at = -1;
+        for (unsigned b = std::max(lo, 1u); b < hi; b++)
+        {
+            if (peaks[b] && (at < 0 || db[b] > db[at])) at = b;
+        }
+        if (at < 0 || db[at] < mean + peak_db) continue;
+        // parabola through the dB of the peak and its neighbours
+        const float y0 = db[at - 1], y1 = db[at], y2 = db[at + 1];
+        const float d = y0 - 2.0f * y1 + y2;
+        const float offset = d < 0.0f ? std::clamp(0.5f * (y0 - y2) / d, -0.5f, 0.5f) : 0.0f;
+        num += h * (at + offset) * df;
+        den += h * h;
+        out.bins[h - 1] = at;
+    }
+    if (den == 0.0) return;
+    out.f0 = static_cast<float>(num / den);
+    out.salience = static_cast<float>(best / harmonics - mean);
+}
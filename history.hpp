@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Last `capacity` samples of one channel, addressed by absolute sample position since init
+struct AudioHistory {
+    std::vector<float> ring;
+    uint64_t written = 0;
+
+    void init(size_t capacity)
+    {
+        ring.assign(capacity, 0.0f);
+        written = 0;
+    }
+
+    uint64_t begin() const { return written > ring.size() ? written - ring.size() : 0; }
+    uint64_t end() const { return written; }
+    // oldest position still stored once `more` samples have been written
+    uint64_t beginAfter(size_t more) const { return written + more > ring.size() ? written + more - ring.size() : 0; }
+
+    void write(const float* data, size_t length)
+    {
+        if (ring.empty()) return;
+        // only the tail survives a block longer than the ring
+        if (length > ring.size()) {
+            written += length - ring.size();
+            data += length - ring.size();
+            length = ring.size();
+        }
+        size_t at = written % ring.size();
+        size_t first = std::min(length, ring.size() - at);
+        std::copy(data, data + first, ring.begin() + at);
+        std::copy(data + first, data + length, ring.begin());
+        written += length;
+    }
+
+    // [pos, pos + length) has to be within [begin(), end())
+    template <typename T>
+    void read(uint64_t pos, T* out, size_t length) const
+    {
+        size_t at = pos % ring.size();
+        size_t first = std::min(length, ring.size() - at);
+        std::copy(ring.begin() + at, ring.begin() + at + first, out);
+        std::copy(ring.begin(), ring.begin() + (length - first), out + first);
+    }
+};
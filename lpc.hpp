@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "simde/x86/avx2.h"
+#include "SimdUtils.hpp"
+
+// All-pole model of one column: prediction coefficients from Levinson-Durbin on the
+// autocorrelation of the pre-emphasised frame, and the formants read off its envelope.
+// Fixed size so columns carry it without allocating.
+struct LinearPrediction {
+    static constexpr unsigned max_order = 48;
+    static constexpr unsigned max_formants = 5;
+    unsigned order = 0;                 // 0 when the column has no model
+    float coefficients[max_order + 1];  // a[0] is 1
+    float gain_db = 0.0f;               // envelope level where |A| is 1, on the column's dB scale
+    float preemphasis = 0.0f;           // taken back out of the envelope
+    unsigned n_formants = 0;
+    float formants[max_formants];       // Hz, ascending
+    float bandwidths[max_formants];     // Hz, -3dB
+};
+
+// r[k] = sum x[i] x[i + k] for k = 0..lags, the frame zero outside its n samples. Four lags
+// per pass share each load of x[i] and keep independent sums.
+void autocorrelation(const float * x, unsigned n, unsigned lags, double * r)
+{
+    unsigned k;
+    for (k = 0; k + 3 <= lags && k + 3 < n; k += 4)
+    {
+        const unsigned m = n - k - 3;
+        simde__m256 acc[4] = { simde_mm256_setzero_ps(), simde_mm256_setzero_ps(), simde_mm256_setzero_ps(), simde_mm256_setzero_ps() };
+        unsigned i;
+        for (i = 0; i < m - m % 8; i += 8)
+        {
+            const simde__m256 v = simde_mm256_loadu_ps(&x[i]);
+            acc[0] = simde_mm256_add_ps(acc[0], simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&x[i + k])));
+            acc[1] = simde_mm256_add_ps(acc[1], simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&x[i + k + 1])));
+            acc[2] = simde_mm256_add_ps(acc[2], simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&x[i + k + 2])));
+            acc[3] = simde_mm256_add_ps(acc[3], simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&x[i + k + 3])));
+        }
+        for (unsigned j = 0; j < 4; j++)
+        {
+            float lanes[8];
+            simde_mm256_storeu_ps(lanes, acc[j]);
+            double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+            // non-vectorisable remaining elements
+            for (unsigned q = i; q < n - k - j; q++) sum += x[q] * x[q + k + j];
+            r[k + j] = sum;
+        }
+    }
+    for (; k <= lags; k++) r[k] = k < n ? simd_buffer_dot(x, x + k, n - k) : 0.0;
+}
+
+void autocorrelation(const double * x, unsigned n, unsigned lags, double * r)
+{
+    unsigned k;
+    for (k = 0; k + 3 <= lags && k + 3 < n; k += 4)
+    {
+        const unsigned m = n - k - 3;
+        simde__m256d acc[4] = { simde_mm256_setzero_pd(), simde_mm256_setzero_pd(), simde_mm256_setzero_pd(), simde_mm256_setzero_pd() };
+        unsigned i;
+        for (i = 0; i < m - m % 4; i += 4)
+        {
+            const simde__m256d v = simde_mm256_loadu_pd(&x[i]);
+            acc[0] = simde_mm256_add_pd(acc[0], simde_mm256_mul_pd(v, simde_mm256_loadu_pd(&x[i + k])));
+            acc[1] = simde_mm256_add_pd(acc[1], simde_mm256_mul_pd(v, simde_mm256_loadu_pd(&x[i + k + 1])));
+            acc[2] = simde_mm256_add_pd(acc[2], simde_mm256_mul_pd(v, simde_mm256_loadu_pd(&x[i + k + 2])));
+            acc[3] = simde_mm256_add_pd(acc[3], simde_mm256_mul_pd(v, simde_mm256_loadu_pd(&x[i + k + 3])));
+        }
+        for (unsigned j = 0; j < 4; j++)
+        {
+            double lanes[4];
+            simde_mm256_storeu_pd(lanes, acc[j]);
+            double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            // non-vectorisable remaining elements
+            for (unsigned q = i; q < n - k - j; q++) sum += x[q] * x[q + k + j];
+            r[k + j] = sum;
+        }
+    }
+    for (; k <= lags; k++) r[k] = k < n ? simd_buffer_dot(x, x + k, n - k) : 0.0;
+}
+
+// Prediction coefficients a[0..order] (a[0] = 1) from the autocorrelation r[0..order], returns
+// the prediction error power, 0 when r isn't positive definite and no model fits
+double levinson_durbin(const double * r, unsigned order, double * a)
+{
+    order = std::min(order, LinearPrediction::max_order);
+    std::fill(a, a + order + 1, 0.0);
+    a[0] = 1.0;
+    double error = r[0];
+    for (unsigned m = 1; m <= order; m++)
+    {
+        if (!(error > 0.0)) return 0.0;
+        // two sums so the additions don't wait on each other
+        double acc0 = r[m], acc1 = 0.0;
+        unsigned j;
+        for (j = 1; j + 1 < m; j += 2)
+        {
+            acc0 += a[j] * r[m - j];
+            acc1 += a[j + 1] * r[m - j - 1];
+        }
+        if (j < m) acc0 += a[j] * r[m - j];
+        const double k = -(acc0 + acc1) / error;
+        if (std::abs(k) >= 1.0) return 0.0;
+        // a[j] and a[m - j] update each other, in place from both ends
+        for (j = 1; 2 * j < m; j++)
+        {
+            const double lo = a[j], hi = a[m - j];
+            a[j] = lo + k * hi;
+            a[m - j] = hi + k * lo;
+        }
+        if (2 * j == m) a[j] += k * a[j];
+        a[m] = k;
+        error *= 1.0 - k * k;
+    }
+    return error;
+}
+
+// Envelope of the model at the angular frequencies omega[i] (radians per sample) in dB: the gain
+// over |A|, the pre-emphasis taken out. Four frequencies at a time, the e^(-j w k) of each
+// advanced by complex rotation.
+void lpc_envelope_db(const LinearPrediction& lp, const float * omega, float * out, unsigned n)
+{
+    const double mu = lp.preemphasis;
+    auto finish = [&](double re, double im, double w) {
+        const double tilt = 1.0 + mu * mu - 2.0 * mu * std::cos(w);
+        return static_cast<float>(lp.gain_db - 10.0 * std::log10(std::max(re * re + im * im, 1e-30) * std::max(tilt, 1e-30)));
+    };
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        double c[4], s[4];
+        for (int l = 0; l < 4; l++)
+        {
+            c[l] = std::cos(omega[i + l]);
+            s[l] = -std::sin(omega[i + l]);
+        }
+        const simde__m256d rot_re = simde_mm256_loadu_pd(c);
+        const simde__m256d rot_im = simde_mm256_loadu_pd(s);
+        simde__m256d p_re = simde_mm256_set1_pd(1.0);
+        simde__m256d p_im = simde_mm256_setzero_pd();
+        simde__m256d re = simde_mm256_setzero_pd();
+        simde__m256d im = simde_mm256_setzero_pd();
+        for (unsigned k = 0; k <= lp.order; k++)
+        {
+            const simde__m256d a = simde_mm256_set1_pd(lp.coefficients[k]);
+            re = simde_mm256_add_pd(re, simde_mm256_mul_pd(a, p_re));
+            im = simde_mm256_add_pd(im, simde_mm256_mul_pd(a, p_im));
+            simde__m256d n_re = simde_mm256_sub_pd(simde_mm256_mul_pd(p_re, rot_re), simde_mm256_mul_pd(p_im, rot_im));
+            simde__m256d n_im = simde_mm256_add_pd(simde_mm256_mul_pd(p_re, rot_im), simde_mm256_mul_pd(p_im, rot_re));
+            p_re = n_re;
+            p_im = n_im;
+        }
+        double lanes_re[4], lanes_im[4];
+        simde_mm256_storeu_pd(lanes_re, re);
+        simde_mm256_storeu_pd(lanes_im, im);
+        for (int l = 0; l < 4; l++) out[i + l] = finish(lanes_re[l], lanes_im[l], omega[i + l]);
+    }
+    // non-vectorisable remaining elements
+    for (unsigned j = i; j < n; j++)
+    {
+        double re = 0.0, im = 0.0;
+        for (unsigned k = 0; k <= lp.order; k++)
+        {
+            re += lp.coefficients[k] * std::cos(omega[j] * k);
+            im -= lp.coefficients[k] * std::sin(omega[j] * k);
+        }
+        out[j] = finish(re, im, omega[j]);
+    }
+}
+
+// One coefficient through the Goertzel resonators of four frequencies, c holding their 2 cos(w)
+static inline void goertzel_step(simde__m256d a, simde__m256d c, simde__m256d& s1, simde__m256d& s2)
+{
+    const simde__m256d s = simde_mm256_sub_pd(simde_mm256_add_pd(a, simde_mm256_mul_pd(c, s1)), s2);
+    s2 = s1;
+    s1 = s;
+}
+
+// |A| = sqrt(s1^2 + s2^2 - 2 cos(w) s1 s2) once every coefficient went through
+static inline void goertzel_magnitudes(simde__m256d c, simde__m256d s1, simde__m256d s2, double * out)
+{
+    const simde__m256d power = simde_mm256_sub_pd(
+        simde_mm256_add_pd(simde_mm256_mul_pd(s1, s1), simde_mm256_mul_pd(s2, s2)),
+        simde_mm256_mul_pd(c, simde_mm256_mul_pd(s1, s2)));
+    simde_mm256_storeu_pd(out, simde_mm256_sqrt_pd(simde_mm256_max_pd(power, simde_mm256_setzero_pd())));
+}
+
+// |A| at the n angular frequencies whose 2 cos(w) are in two_cos, the coefficients run through a
+// Goertzel resonator per frequency. Sixteen frequencies at a time so the four recursions hide
+// each other's latency. For a stretch of bins this is far cheaper than a transform of the frame.
+void lpc_inverse_magnitudes(const LinearPrediction& lp, const double * two_cos, double * out, unsigned n)
+{
+    const simde__m256d zero = simde_mm256_setzero_pd();
+    unsigned i;
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        const simde__m256d c0 = simde_mm256_loadu_pd(&two_cos[i]);
+        const simde__m256d c1 = simde_mm256_loadu_pd(&two_cos[i + 4]);
+        const simde__m256d c2 = simde_mm256_loadu_pd(&two_cos[i + 8]);
+        const simde__m256d c3 = simde_mm256_loadu_pd(&two_cos[i + 12]);
+        simde__m256d a0 = zero, b0 = zero, a1 = zero, b1 = zero, a2 = zero, b2 = zero, a3 = zero, b3 = zero;
+        for (unsigned k = 0; k <= lp.order; k++)
+        {
+            const simde__m256d a = simde_mm256_set1_pd(lp.coefficients[k]);
+            goertzel_step(a, c0, a0, b0);
+            goertzel_step(a, c1, a1, b1);
+            goertzel_step(a, c2, a2, b2);
+            goertzel_step(a, c3, a3, b3);
+        }
+        goertzel_magnitudes(c0, a0, b0, &out[i]);
+        goertzel_magnitudes(c1, a1, b1, &out[i + 4]);
+        goertzel_magnitudes(c2, a2, b2, &out[i + 8]);
+        goertzel_magnitudes(c3, a3, b3, &out[i + 12]);
+    }
+    for (; i < n - n % 4; i += 4)
+    {
+        const simde__m256d c = simde_mm256_loadu_pd(&two_cos[i]);
+        simde__m256d s1 = zero, s2 = zero;
+        for (unsigned k = 0; k <= lp.order; k++) goertzel_step(simde_mm256_set1_pd(lp.coefficients[k]), c, s1, s2);
+        goertzel_magnitudes(c, s1, s2, &out[i]);
+    }
+    // non-vectorisable remaining elements
+    for (unsigned j = i; j < n; j++)
+    {
+        double s1 = 0.0, s2 = 0.0;
+        for (unsigned k = 0; k <= lp.order; k++)
+        {
+            const double s = lp.coefficients[k] + two_cos[j] * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        out[j] = std::sqrt(std::max(s1 * s1 + s2 * s2 - two_cos[j] * s1 * s2, 0.0));
+    }
+}
+
+// Formants from the peaks of the pre-emphasised envelope, given as 20 log10 |A| on a grid of
+// df Hz (the envelope is its negative): every peak between lo and hi Hz, refined with a
+// parabola, whose -3dB bandwidth from the parabola's curvature is under max_bandwidth
+void find_formants(const float * a_db, unsigned n, float df, float lo, float hi, float max_bandwidth,
+                   LinearPrediction& lp)
+{
+    lp.n_formants = 0;
+    const unsigned k_lo = std::max(1, static_cast<int>(std::ceil(lo / df)));
+    const unsigned k_hi = std::min(n - 1, static_cast<unsigned>(hi / df));
+    for (unsigned k = k_lo; k < k_hi && lp.n_formants < LinearPrediction::max_formants; k++)
+    {
+        // peaks of the envelope are dips of |A|
+        if (!(a_db[k] < a_db[k - 1] && a_db[k] <= a_db[k + 1])) continue;
+        const float y0 = -a_db[k - 1], y1 = -a_db[k], y2 = -a_db[k + 1];
+        const float d = y0 - 2.0f * y1 + y2;
+        if (!(d < 0.0f)) continue;
+        const float offset = std::clamp(0.5f * (y0 - y2) / d, -0.5f, 0.5f);
+        // y1 - c x^2 with c = -d / 2 drops 3dB at x = sqrt(3 / c) bins either side
+        const float bandwidth = 2.0f * std::sqrt(6.0f / -d) * df;
+        if (bandwidth > max_bandwidth) continue;
+        lp.formants[lp.n_formants] = (k + offset) * df;
+        lp.bandwidths[lp.n_formants] = bandwidth;
+        lp.n_formants++;
+    }
+}
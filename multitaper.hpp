@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+#include "acf.hpp"
+
+// Solves a symmetric tridiagonal system shifted by mu, LU with partial pivoting as LAPACK's
+// dgttrf / dgttrs, for inverse iteration on nearly singular shifts
+struct TridiagonalSolver {
+    std::vector<double> dl, d, du, du2;
+    std::vector<bool> swapped;
+
+    // diag of n values, off of n - 1 (off[i] couples i and i + 1)
+    void factor(const std::vector<double>& diag, const std::vector<double>& off, double mu)
+    {
+        const size_t n = diag.size();
+        d.resize(n);
+        for (size_t i = 0; i < n; i++) d[i] = diag[i] - mu;
+        dl = off;
+        du = off;
+        du2.assign(n, 0.0);
+        swapped.assign(n, false);
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            if (std::abs(d[i]) >= std::abs(dl[i]))
+            {
+                if (d[i] == 0.0) d[i] = 1e-300;
+                const double fact = dl[i] / d[i];
+                dl[i] = fact;
+                d[i + 1] -= fact * du[i];
+            }
+            else
+            {
+                const double fact = d[i] / dl[i];
+                d[i] = dl[i];
+                dl[i] = fact;
+                const double temp = du[i];
+                du[i] = d[i + 1];
+                d[i + 1] = temp - fact * d[i + 1];
+                if (i + 2 < n)
+                {
+                    du2[i] = du[i + 1];
+                    du[i + 1] = -fact * du[i + 1];
+                }
+                swapped[i] = true;
+            }
+        }
+        if (d[n - 1] == 0.0) d[n - 1] = 1e-300;
+    }
+
+    void solve(std::vector<double>& b) const
+    {
+        const size_t n = d.size();
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            if (swapped[i])
+            {
+                const double temp = b[i];
+                b[i] = b[i + 1];
+                b[i + 1] = temp - dl[i] * b[i];
+            }
+            else
+            {
+                b[i + 1] -= dl[i] * b[i];
+            }
+        }
+        b[n - 1] /= d[n - 1];
+        if (n > 1) b[n - 2] = (b[n - 2] - du[n - 2] * b[n - 1]) / d[n - 2];
+        for (size_t i = n - 2; i-- > 0;)
+        {
+            b[i] = (b[i] - du[i] * b[i + 1] - du2[i] * b[i + 2]) / d[i];
+        }
+    }
+};
+
+// Discrete prolate spheroidal sequences (Slepian tapers) of length n and time half bandwidth
+// product nw, the `count` most concentrated in the band |f| < nw / n. They are the eigenvectors
+// of the tridiagonal matrix commuting with the concentration problem (Percival & Walden, 8.3):
+// its largest eigenvalues by Sturm bisection, each vector by inverse iteration. Every taper has
+// unit energy, `ratios` holds the share of it inside the band.
+template <typename T>
+struct Tapers {
+    uint32_t size = 0;
+    unsigned count = 0;
+    std::vector<T> windows; // count rows of size
+    std::vector<T> ratios;
+
+    void compute(uint32_t n, double nw, unsigned k)
+    {
+        size = n;
+        count = k;
+        windows.resize(static_cast<size_t>(k) * n);
+        ratios.resize(k);
+        const double w = nw / n;
+        std::vector<double> diag(n), off(n > 1 ? n - 1 : 0);
+        for (uint32_t i = 0; i < n; i++) diag[i] = std::pow((n - 1 - 2.0 * i) / 2.0, 2.0) * std::cos(2.0 * M_PI * w);
+        for (uint32_t i = 1; i < n; i++) off[i - 1] = i * (n - static_cast<double>(i)) / 2.0;
+
+        // eigenvalues under x, by the signs of the LDL^T pivots
+        auto count_below = [&](double x) {
+            unsigned below = 0;
+            double q = diag[0] - x;
+            if (q < 0.0) below++;
+            for (uint32_t i = 1; i < n; i++)
+            {
+                q = diag[i] - x - off[i - 1] * off[i - 1] / (q != 0.0 ? q : 1e-300);
+                if (q < 0.0) below++;
+            }
+            return below;
+        };
+        double lo = diag[0], hi = diag[0];
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const double r = (i > 0 ? off[i - 1] : 0.0) + (i + 1 < n ? off[i] : 0.0);
+            lo = std::min(lo, diag[i] - r);
+            hi = std::max(hi, diag[i] + r);
+        }
+
+        TridiagonalSolver solver;
+        Autocorrelation autocorrelation;
+        autocorrelation.init(n);
+        std::vector<double> v(n);
+        for (unsigned t = 0; t < k; t++)
+        {
+            // the (t + 1)th largest eigenvalue: n - 1 - t of them lie under it
+            double a = lo, b = hi;
+            for (int it = 0; it < 100 && b - a > 1e-13 * std::max(1.0, std::abs(b)); it++)
+            {
+                const double mid = 0.5 * (a + b);
+                if (count_below(mid) > n - 1 - t) b = mid;
+                else a = mid;
+            }
+            solver.factor(diag, off, 0.5 * (a + b));
+            for (uint32_t i = 0; i < n; i++) v[i] = 1.0 + 0.01 * std::sin(1.0 + i);
+            for (int it = 0; it < 3; it++)
+            {
+                solver.solve(v);
+                double norm = 0.0;
+                for (double x : v) norm += x * x;
+                norm = 1.0 / std::sqrt(norm);
+                for (double& x : v) x *= norm;
+            }
+            // even tapers sum to a positive value, odd ones start rising
+            double sign = 0.0;
+            for (uint32_t i = 0; i < n; i++) sign += (t % 2 == 0 ? 1.0 : (n - 1) / 2.0 - i) * v[i];
+            if (sign < 0.0) for (double& x : v) x = -x;
+            std::copy(v.begin(), v.end(), windows.begin() + static_cast<size_t>(t) * n);
+
+            // energy in the band from the autocorrelation of the taper against the band's sinc
+            const std::vector<double>& r = autocorrelation.compute(v.data(), n);
+            double ratio = 2.0 * w * r[0];
+            for (uint32_t lag = 1; lag < n; lag++) ratio += 2.0 * r[lag] * std::sin(2.0 * M_PI * w * lag) / (M_PI * lag);
+            ratios[t] = static_cast<T>(std::clamp(ratio, 0.0, 1.0));
+        }
+    }
+};
+
+// Tapers cached per length and nw, entries are never removed so references stay valid
+template <typename T>
+const Tapers<T>& cached_dpss(uint32_t n, float nw)
+{
+    static std::map<std::pair<uint32_t, float>, Tapers<T>> cache;
+    auto key = std::make_pair(n, nw);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, Tapers<T>()).first;
+        it->second.compute(n, nw, std::max(1, static_cast<int>(2.0f * nw) - 1));
+    }
+    return it->second;
+}
+
+// Thomson's adaptive weighting of k eigenspectra (magnitudes, k rows of n) into one magnitude
+// per bin: each taper weighs in by how much of the estimate it can hold against its broadband
+// leakage, d_k^2 = ratio_k (S / (ratio_k S + (1 - ratio_k) variance))^2, S the weighted mean of
+// the powers, started from the first two and iterated a fixed number of times.
+void adaptive_multitaper(const float * magnitudes, const float * ratios, unsigned k, unsigned n, float variance,
+                         unsigned iterations, float * out)
+{
+    const simde__m256 var = simde_mm256_set1_ps(variance);
+    const simde__m256 tiny = simde_mm256_set1_ps(1e-30f);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 m0 = simde_mm256_loadu_ps(&magnitudes[i]);
+        simde__m256 s = simde_mm256_mul_ps(m0, m0);
+        if (k > 1)
+        {
+            simde__m256 m1 = simde_mm256_loadu_ps(&magnitudes[n + i]);
+            s = simde_mm256_mul_ps(simde_mm256_add_ps(s, simde_mm256_mul_ps(m1, m1)), simde_mm256_set1_ps(0.5f));
+        }
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            simde__m256 num = simde_mm256_setzero_ps(), den = tiny;
+            for (unsigned t = 0; t < k; t++)
+            {
+                const simde__m256 r = simde_mm256_set1_ps(ratios[t]);
+                simde__m256 a = simde_mm256_add_ps(simde_mm256_mul_ps(r, s), simde_mm256_mul_ps(simde_mm256_set1_ps(1.0f - ratios[t]), var));
+                a = simde_mm256_max_ps(a, tiny);
+                simde__m256 q = simde_mm256_div_ps(s, a);
+                simde__m256 d2 = simde_mm256_mul_ps(r, simde_mm256_mul_ps(q, q));
+                simde__m256 m = simde_mm256_loadu_ps(&magnitudes[t * n + i]);
+                num = simde_mm256_add_ps(num, simde_mm256_mul_ps(d2, simde_mm256_mul_ps(m, m)));
+                den = simde_mm256_add_ps(den, d2);
+            }
+            s = simde_mm256_div_ps(num, den);
+        }
+        simde_mm256_storeu_ps(&out[i], simde_mm256_sqrt_ps(s));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned j = i; j < n; j++)
+    {
+        float s = magnitudes[j] * magnitudes[j];
+        if (k > 1) s = 0.5f * (s + magnitudes[n + j] * magnitudes[n + j]);
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            float num = 0.0f, den = 1e-30f;
+            for (unsigned t = 0; t < k; t++)
+            {
+                const float a = std::max(ratios[t] * s + (1.0f - ratios[t]) * variance, 1e-30f);
+                const float q = s / a;
+                const float d2 = ratios[t] * q * q;
+                num += d2 * magnitudes[t * n + j] * magnitudes[t * n + j];
+                den += d2;
+            }
+            s = num / den;
+        }
+        out[j] = std::sqrt(s);
+    }
+}
+
+void adaptive_multitaper(const double * magnitudes, const double * ratios, unsigned k, unsigned n, double variance,
+                         unsigned iterations, double * out)
+{
+    const simde__m256d var = simde_mm256_set1_pd(variance);
+    const simde__m256d tiny = simde_mm256_set1_pd(1e-300);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d m0 = simde_mm256_loadu_pd(&magnitudes[i]);
+        simde__m256d s = simde_mm256_mul_pd(m0, m0);
+        if (k > 1)
+        {
+            simde__m256d m1 = simde_mm256_loadu_pd(&magnitudes[n + i]);
+            s = simde_mm256_mul_pd(simde_mm256_add_pd(s, simde_mm256_mul_pd(m1, m1)), simde_mm256_set1_pd(0.5));
+        }
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            simde__m256d num = simde_mm256_setzero_pd(), den = tiny;
+            for (unsigned t = 0; t < k; t++)
+            {
+                const simde__m256d r = simde_mm256_set1_pd(ratios[t]);
+                simde__m256d a = simde_mm256_add_pd(simde_mm256_mul_pd(r, s), simde_mm256_mul_pd(simde_mm256_set1_pd(1.0 - ratios[t]), var));
+                a = simde_mm256_max_pd(a, tiny);
+                simde__m256d q = simde_mm256_div_pd(s, a);
+                simde__m256d d2 = simde_mm256_mul_pd(r, simde_mm256_mul_pd(q, q));
+                simde__m256d m = simde_mm256_loadu_pd(&magnitudes[t * n + i]);
+                num = simde_mm256_add_pd(num, simde_mm256_mul_pd(d2, simde_mm256_mul_pd(m, m)));
+                den = simde_mm256_add_pd(den, d2);
+            }
+            s = simde_mm256_div_pd(num, den);
+        }
+        simde_mm256_storeu_pd(&out[i], simde_mm256_sqrt_pd(s));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned j = i; j < n; j++)
+    {
+        double s = magnitudes[j] * magnitudes[j];
+        if (k > 1) s = 0.5 * (s + magnitudes[n + j] * magnitudes[n + j]);
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            double num = 0.0, den = 1e-300;
+            for (unsigned t = 0; t < k; t++)
+            {
+                const double a = std::max(ratios[t] * s + (1.0 - ratios[t]) * variance, 1e-300);
+                const double q = s / a;
+                const double d2 = ratios[t] * q * q;
+                num += d2 * magnitudes[t * n + j] * magnitudes[t * n + j];
+                den += d2;
+            }
+            s = num / den;
+        }
+        out[j] = std::sqrt(s);
+    }
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+enum FloorMode {
+    kFloorOff = 0,
+    kFloorGate,
+    kFloorNormalize,
+    kFloorCount
+};
+
+// One pass per column: x (dB) smoothed by a one pole into `smoothed`, `current` follows the
+// smoothed value down for the sub-window in progress, and the floor is the lower of it and the
+// minimum of the finished sub-windows, plus the bias
+void update_floor(const float * x, float * smoothed, float * current, const float * window_min, float * floor,
+                  unsigned n, float alpha, float bias_db)
+{
+    const simde__m256 a = simde_mm256_set1_ps(alpha);
+    const simde__m256 b = simde_mm256_set1_ps(bias_db);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 s = simde_mm256_loadu_ps(&smoothed[i]);
+        s = simde_mm256_add_ps(simde_mm256_loadu_ps(&x[i]), simde_mm256_mul_ps(a, simde_mm256_sub_ps(s, simde_mm256_loadu_ps(&x[i]))));
+        simde_mm256_storeu_ps(&smoothed[i], s);
+        simde__m256 c = simde_mm256_min_ps(simde_mm256_loadu_ps(&current[i]), s);
+        simde_mm256_storeu_ps(&current[i], c);
+        simde_mm256_storeu_ps(&floor[i], simde_mm256_add_ps(simde_mm256_min_ps(c, simde_mm256_loadu_ps(&window_min[i])), b));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        smoothed[k] = x[k] + alpha * (smoothed[k] - x[k]);
+        current[k] = std::min(current[k], smoothed[k]);
+        floor[k] = std::min(current[k], window_min[k]) + bias_db;
+    }
+}
+
+// out = min(out, x)
+void min_into(float * out, const float * x, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde_mm256_storeu_ps(&out[i], simde_mm256_min_ps(simde_mm256_loadu_ps(&out[i]), simde_mm256_loadu_ps(&x[i])));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = std::min(out[k], x[k]);
+    }
+}
+
+// Bins less than above_db over the floor go to gated_db, their magnitude to 0
+void gate_to_floor(float * db, float * bins, const float * floor, unsigned n, float above_db, float gated_db)
+{
+    const simde__m256 above = simde_mm256_set1_ps(above_db);
+    const simde__m256 gated = simde_mm256_set1_ps(gated_db);
+    const simde__m256 zero = simde_mm256_setzero_ps();
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_loadu_ps(&db[i]);
+        simde__m256 under = simde_mm256_cmp_ps(v, simde_mm256_add_ps(simde_mm256_loadu_ps(&floor[i]), above), SIMDE_CMP_LT_OQ);
+        simde_mm256_storeu_ps(&db[i], simde_mm256_blendv_ps(v, gated, under));
+        simde_mm256_storeu_ps(&bins[i], simde_mm256_blendv_ps(simde_mm256_loadu_ps(&bins[i]), zero, under));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        if (db[k] < floor[k] + above_db)
+        {
+            db[k] = gated_db;
+            bins[k] = 0.0f;
+        }
+    }
+}
+
+void gate_to_floor(float * db, double * bins, const float * floor, unsigned n, float above_db, float gated_db)
+{
+    const simde__m256 above = simde_mm256_set1_ps(above_db);
+    const simde__m256 gated = simde_mm256_set1_ps(gated_db);
+    const simde__m256d zero = simde_mm256_setzero_pd();
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_loadu_ps(&db[i]);
+        simde__m256 under = simde_mm256_cmp_ps(v, simde_mm256_add_ps(simde_mm256_loadu_ps(&floor[i]), above), SIMDE_CMP_LT_OQ);
+        simde_mm256_storeu_ps(&db[i], simde_mm256_blendv_ps(v, gated, under));
+        // the lane masks widened to 64 bits for the double magnitudes
+        simde__m256i mask = simde_mm256_castps_si256(under);
+        simde__m256d lo = simde_mm256_castsi256_pd(simde_mm256_cvtepi32_epi64(simde_mm256_castsi256_si128(mask)));
+        simde__m256d hi = simde_mm256_castsi256_pd(simde_mm256_cvtepi32_epi64(simde_mm256_extracti128_si256(mask, 1)));
+        simde_mm256_storeu_pd(&bins[i], simde_mm256_blendv_pd(simde_mm256_loadu_pd(&bins[i]), zero, lo));
+        simde_mm256_storeu_pd(&bins[i + 4], simde_mm256_blendv_pd(simde_mm256_loadu_pd(&bins[i + 4]), zero, hi));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        if (db[k] < floor[k] + above_db)
+        {
+            db[k] = gated_db;
+            bins[k] = 0.0;
+        }
+    }
+}
+
+// Every bin's floor moved to reference_db
+void normalize_to_floor(float * db, const float * floor, unsigned n, float reference_db)
+{
+    const simde__m256 ref = simde_mm256_set1_ps(reference_db);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_sub_ps(simde_mm256_loadu_ps(&db[i]), simde_mm256_loadu_ps(&floor[i]));
+        simde_mm256_storeu_ps(&db[i], simde_mm256_add_ps(v, ref));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        db[k] = db[k] - floor[k] + reference_db;
+    }
+}
+
+// Expected maximum of n standard normal samples, by integrating its density
+static inline double expected_normal_max(double n)
+{
+    if (n <= 1.0) return 0.0;
+    double sum = 0.0;
+    const double dx = 0.01;
+    for (double x = -8.0; x < 8.0; x += dx)
+    {
+        const double pdf = std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI);
+        const double cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+        sum += x * n * pdf * std::pow(cdf, n - 1.0) * dx;
+    }
+    return sum;
+}
+
+// Per-bin noise floor by minimum statistics (Martin, "Noise power spectral density estimation
+// based on optimal smoothing and minimum statistics"): the minimum of the smoothed dB levels over
+// the last window of columns, which a sound has to hold for the whole window to raise. The window
+// is split into sub_windows so the minimum slides by one sub-window at a time: each column only
+// smooths and follows the minimum of the sub-window in progress, the finished ones are combined
+// once per sub-window.
+//
+// The minimum sits under the mean level of noise by bias_db, which depends on how many
+// independent spectra the smoothing averages and how many independent smoothed values the window
+// holds. Spectra of frames overlapping by more than half are counted as one. The dB of a noise
+// bin has a 5.57 dB deviation and averages 2.51 dB under its mean power; the smoothed level is
+// taken as normal with the deviation shrunk by the square root of the spectra averaged, its
+// minimum as the expected one of that many independent values.
+struct NoiseFloor {
+    static constexpr unsigned sub_windows = 8;
+    float bias_db = 0.0f;
+    float alpha = 0.9f;
+    uint32_t sub_window_columns = 16;
+
+    size_t size = 0;
+    uint32_t count = 0;
+    uint32_t finished = 0;
+    std::vector<float> smoothed;
+    std::vector<float> current;
+    // minima of the finished sub-windows, oldest one overwritten first
+    std::vector<float> minima;
+    std::vector<float> window_min;
+    std::vector<float> floor;
+
+    // Column rate and analysis frame length, smoothing time constant and window in seconds
+    void setup(float seconds_per_column, float frame_seconds, float window_seconds, float smoothing_seconds)
+    {
+        alpha = std::exp(-seconds_per_column / smoothing_seconds);
+        const float columns = window_seconds / seconds_per_column;
+        sub_window_columns = std::max(1u, static_cast<uint32_t>(std::lround(columns / sub_windows)));
+
+        const double independent = std::max(seconds_per_column, 0.5f * frame_seconds);
+        // a one pole averages about (1 + alpha) / (1 - alpha) columns
+        const double averaged = std::max(1.0, (1.0 + alpha) / (1.0 - alpha) * seconds_per_column / independent);
+        const double candidates = window_seconds / std::max(independent, static_cast<double>(smoothing_seconds));
+        bias_db = static_cast<float>(2.51 + 5.57 / std::sqrt(averaged) * expected_normal_max(candidates));
+        reset();
+    }
+
+    void reset()
+    {
+        size = 0;
+    }
+
+    void update(const float * db, size_t n)
+    {
+        if (size != n)
+        {
+            // the first column seeds the smoothing, no finished sub-window yet
+            size = n;
+            smoothed.assign(db, db + n);
+            current.assign(db, db + n);
+            minima.assign(sub_windows * n, 0.0f);
+            window_min.assign(n, INFINITY);
+            floor.resize(n);
+            count = 0;
+            finished = 0;
+        }
+        update_floor(db, smoothed.data(), current.data(), window_min.data(), floor.data(), n, alpha, bias_db);
+        if (++count < sub_window_columns) return;
+
+        std::copy(current.begin(), current.end(), minima.begin() + (finished % sub_windows) * n);
+        finished++;
+        std::copy(current.begin(), current.end(), window_min.begin());
+        for (unsigned w = 0; w < std::min(finished, sub_windows); w++)
+            min_into(window_min.data(), minima.data() + w * n, n);
+        std::copy(smoothed.begin(), smoothed.end(), current.begin());
+        count = 0;
+    }
+};
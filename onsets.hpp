@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+#include "acf.hpp"
+#include "descriptors.hpp"
+
+// Half-wave rectified flux of log magnitudes: mean dB increase per bin since the previous
+// column, anything under floor_db counts as floor_db so silent bins don't add noise
+float log_flux(const float * db, const float * prev, unsigned n, float floor_db)
+{
+    const simde__m256 zero = simde_mm256_setzero_ps();
+    const simde__m256 fl = simde_mm256_set1_ps(floor_db);
+    simde__m256 acc = zero;
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 a = simde_mm256_max_ps(simde_mm256_loadu_ps(&db[i]), fl);
+        simde__m256 b = simde_mm256_max_ps(simde_mm256_loadu_ps(&prev[i]), fl);
+        acc = simde_mm256_add_ps(acc, simde_mm256_max_ps(simde_mm256_sub_ps(a, b), zero));
+    }
+    double sum = hsum_ps(acc);
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        sum += std::max(0.0f, std::max(db[k], floor_db) - std::max(prev[k], floor_db));
+    }
+    return n > 0 ? sum / n : 0.0f;
+}
+
+// Peak picking on the onset detection function, one value per column (Dixon, "Onset detection
+// revisited"): a column is an onset when it's the largest within `wait` columns either side,
+// exceeds the mean from `average` columns before to `wait` after it by `delta` and comes more
+// than `wait` columns after the previous onset. Each column is decided `wait` columns late.
+struct OnsetDetector {
+    unsigned wait = 2;
+    unsigned average = 8;
+    float delta = 1.0f;
+    std::vector<float> values;
+    uint64_t pushed = 0;
+    uint64_t last_onset = 0;
+    bool any = false;
+
+    void init(unsigned _wait, unsigned _average)
+    {
+        wait = std::max(1u, _wait);
+        average = std::max(wait, _average);
+        values.assign(average + wait + 1, 0.0f);
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(values.begin(), values.end(), 0.0f);
+        pushed = 0;
+        any = false;
+    }
+
+    float at(uint64_t column) const { return values[column % values.size()]; }
+
+    // True when the column `wait` before this one is an onset, its index goes to `onset`
+    bool push(float v, uint64_t& onset)
+    {
+        values[pushed % values.size()] = v;
+        pushed++;
+        if (pushed < values.size()) return false;
+
+        const uint64_t c = pushed - 1 - wait;
+        const float x = at(c);
+        for (uint64_t j = c - wait; j <= c + wait; j++)
+        {
+            if (at(j) > x) return false;
+        }
+        double sum = 0.0;
+        for (float value : values) sum += value;
+        if (x < sum / values.size() + delta) return false;
+        if (any && c - last_onset <= wait) return false;
+
+        last_onset = c;
+        any = true;
+        onset = c;
+        return true;
+    }
+};
+
+// Sample in [block, n - block) where the energy of the `block` samples from there on rises the
+// most over the `block` samples before, as a ratio, what an attack looks like at full resolution
+size_t refine_onset(const float * x, size_t n, size_t block)
+{
+    if (n < 2 * block + 1) return n / 2;
+    double before = 0.0, after = 0.0;
+    for (size_t i = 0; i < block; i++)
+    {
+        before += static_cast<double>(x[i]) * x[i];
+        after += static_cast<double>(x[block + i]) * x[block + i];
+    }
+    const double eps = 1e-12 * block;
+    size_t best = block;
+    double best_ratio = (after + eps) / (before + eps);
+    for (size_t i = block + 1; i + block <= n; i++)
+    {
+        // slide both windows by one sample
+        const double leaving = x[i - 1 - block], moving = x[i - 1], entering = x[i + block - 1];
+        before += moving * moving - leaving * leaving;
+        after += entering * entering - moving * moving;
+        const double ratio = (std::max(after, 0.0) + eps) / (std::max(before, 0.0) + eps);
+        if (ratio > best_ratio)
+        {
+            best_ratio = ratio;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Tempo from the autocorrelation of the onset detection function over the last `seconds`,
+// recomputed once a second. Lags are weighted by a log-Gaussian prior one octave
+// wide around prior_bpm, which settles the octave the strongest periodicity is counted in.
+struct TempoEstimator {
+    float columns_per_second = 0.0f;
+    float min_bpm = 60.0f;
+    float max_bpm = 200.0f;
+    float prior_bpm = 120.0f;
+    std::vector<float> envelope;
+    std::vector<double> frame;
+    // prior weight of every lag
+    std::vector<double> weights;
+    Autocorrelation autocorrelation;
+    uint64_t pushed = 0;
+    unsigned interval = 1;
+
+    float bpm = 0.0f;
+    // autocorrelation at the chosen lag over the one at lag 0
+    float confidence = 0.0f;
+
+    void init(float _columns_per_second, float seconds)
+    {
+        columns_per_second = _columns_per_second;
+        const size_t n = std::max<size_t>(8, static_cast<size_t>(seconds * columns_per_second));
+        envelope.assign(n, 0.0f);
+        frame.resize(n);
+        autocorrelation.init(n);
+        weights.resize(n);
+        for (size_t lag = 1; lag < n; lag++)
+        {
+            const double octaves = std::log2(60.0 * columns_per_second / lag / prior_bpm);
+            weights[lag] = std::exp(-0.5 * octaves * octaves);
+        }
+        interval = std::max(1u, static_cast<unsigned>(columns_per_second));
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(envelope.begin(), envelope.end(), 0.0f);
+        pushed = 0;
+        bpm = 0.0f;
+        confidence = 0.0f;
+    }
+
+    // True when a new estimate was made
+    bool push(float v)
+    {
+        if (envelope.empty()) return false;
+        envelope[pushed % envelope.size()] = v;
+        pushed++;
+        if (pushed < envelope.size() || pushed % interval != 0) return false;
+        estimate();
+        return true;
+    }
+
+    void estimate()
+    {
+        const size_t n = envelope.size();
+        double mean = 0.0;
+        for (float v : envelope) mean += v;
+        mean /= n;
+        // oldest first
+        for (size_t i = 0; i < n; i++) frame[i] = envelope[(pushed + i) % n] - mean;
+        const std::vector<double>& acf = autocorrelation.compute(frame.data(), n);
+        if (acf[0] <= 0.0)
+        {
+            bpm = 0.0f;
+            confidence = 0.0f;
+            return;
+        }
+
+        const size_t lo = std::max<size_t>(1, static_cast<size_t>(std::floor(60.0f * columns_per_second / max_bpm)));
+        const size_t hi = std::min(n - 2, static_cast<size_t>(std::ceil(60.0f * columns_per_second / min_bpm)));
+        size_t best = 0;
+        double best_score = 0.0;
+        for (size_t lag = lo; lag <= hi; lag++)
+        {
+            const double score = acf[lag] * weights[lag];
+            if (score > best_score)
+            {
+                best_score = score;
+                best = lag;
+            }
+        }
+        if (best == 0)
+        {
+            bpm = 0.0f;
+            confidence = 0.0f;
+            return;
+        }
+        // parabola through the raw autocorrelation around the peak
+        const double y0 = acf[best - 1], y1 = acf[best], y2 = acf[best + 1];
+        const double d = y0 - 2.0 * y1 + y2;
+        const double offset = d < 0.0 ? std::clamp(0.5 * (y0 - y2) / d, -0.5, 0.5) : 0.0;
+        bpm = static_cast<float>(60.0 * columns_per_second / (best + offset));
+        confidence = static_cast<float>(std::clamp(y1 / acf[0], 0.0, 1.0));
+    }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Spectral peak refined between bins
+struct PartialPeak {
+    float frequency; // Hz
+    float db;
+};
+
+// Peaks flagged in `peaks` no more than range_db under the loudest bin, the max_peaks loudest of
+// them, in ascending frequency. Frequency and level come from a parabola through the dB of the
+// peak and its neighbours, frequencyAt(k) gives the centre of bin k.
+template <typename F>
+void find_partial_peaks(const float * db, const std::vector<bool>& peaks, unsigned n, F&& frequencyAt,
+                        float range_db, size_t max_peaks, std::vector<PartialPeak>& out)
+{
+    out.clear();
+    if (n < 3) return;
+    const float threshold = *std::max_element(db, db + n) - range_db;
+    for (unsigned k = 1; k + 1 < n; k++)
+    {
+        if (!peaks[k] || db[k] < threshold) continue;
+        const float y0 = db[k - 1], y1 = db[k], y2 = db[k + 1];
+        const float d = y0 - 2.0f * y1 + y2;
+        const float offset = d < 0.0f ? std::clamp(0.5f * (y0 - y2) / d, -0.5f, 0.5f) : 0.0f;
+        const float f = frequencyAt(k) + offset * 0.5f * (frequencyAt(k + 1) - frequencyAt(k - 1));
+        out.push_back({ f, y1 - 0.25f * (y0 - y2) * offset });
+    }
+    if (out.size() > max_peaks)
+    {
+        std::nth_element(out.begin(), out.begin() + max_peaks, out.end(),
+                         [](const PartialPeak& a, const PartialPeak& b) { return a.db > b.db; });
+        out.resize(max_peaks);
+        std::sort(out.begin(), out.end(),
+                  [](const PartialPeak& a, const PartialPeak& b) { return a.frequency < b.frequency; });
+    }
+}
+
+// McAulay-Quatieri style partial tracking. The peaks of each column continue the tracks of the
+// previous one: each peak is paired with its neighbours in frequency among the previous peaks,
+// pairs go from the cheapest up (frequency step over the largest allowed plus level step over
+// max_db_step) and a pair is kept while neither side was taken. Peaks left over start a track,
+// tracks left over die. Pairing walks both columns in frequency order, sorting the pairs makes
+// it O(peaks log peaks) per column.
+//
+// Points live in one arena, column after column, each pointing back to the point it continues,
+// the last max_columns columns are kept.
+struct PartialTracker {
+    float max_cents = 50.0f;
+    // smallest frequency step always allowed, about a bin at the bottom of the spectrum
+    float min_step_hz = 0.0f;
+    float max_db_step = 30.0f;
+    size_t max_columns = 1000;
+    static constexpr size_t max_peaks = 65536;
+
+    struct Point {
+        float frequency;
+        float db;
+        uint32_t track;
+        // points back to the one this continues in the previous column, 0 for a birth
+        uint32_t prev;
+    };
+    std::vector<Point> points;
+    // start of every kept column in points, then the end of the newest one
+    std::vector<size_t> column_start{ 0 };
+    // absolute index of the oldest kept column
+    uint64_t first_column = 0;
+    uint32_t next_track = 0;
+    uint64_t born = 0;
+    uint64_t died = 0;
+
+    // a pair sorts on its cost in the high half, the bits of a positive float order like it,
+    // the peak and the previous peak it would continue are 16 bits each in the low half
+    std::vector<uint64_t> candidates;
+    std::vector<uint32_t> matched;
+    std::vector<bool> prev_taken;
+
+    void init(size_t _max_columns, float _min_step_hz)
+    {
+        max_columns = std::max<size_t>(1, _max_columns);
+        min_step_hz = _min_step_hz;
+        reset();
+    }
+
+    void reset()
+    {
+        points.clear();
+        column_start.assign(1, 0);
+        first_column = 0;
+        next_track = 0;
+        born = 0;
+        died = 0;
+    }
+
+    size_t columnCount() const { return column_start.size() - 1; }
+    // absolute index the next column will get
+    uint64_t columnsEnd() const { return first_column + columnCount(); }
+    size_t alive() const { return columnCount() > 0 ? points.size() - column_start[columnCount() - 1] : 0; }
+
+    // Points of kept column c, counted from the oldest one kept
+    const Point * columnBegin(size_t c) const { return points.data() + column_start[c]; }
+    const Point * columnEnd(size_t c) const { return points.data() + column_start[c + 1]; }
+
+    // Peaks of the next column, ascending in frequency, at most max_peaks of them
+    void push(const std::vector<PartialPeak>& peaks)
+    {
+        const size_t p0 = columnCount() > 0 ? column_start[columnCount() - 1] : points.size();
+        const size_t p1 = points.size();
+        const Point * prev = points.data() + p0;
+        const size_t n_prev = p1 - p0;
+        const size_t n_peaks = std::min(peaks.size(), max_peaks);
+        const float ratio = std::exp2(max_cents / 1200.0f) - 1.0f;
+
+        candidates.clear();
+        size_t j = 0;
+        for (size_t i = 0; i < n_peaks; i++)
+        {
+            const PartialPeak& peak = peaks[i];
+            const float allowed = std::max(min_step_hz, peak.frequency * ratio);
+            // the previous peaks right below and right above, both sides are in ascending order
+            while (j < n_prev && prev[j].frequency < peak.frequency) j++;
+            for (size_t k = j > 0 ? j - 1 : 0; k < std::min(j + 1, n_prev); k++)
+            {
+                const float df = std::abs(peak.frequency - prev[k].frequency);
+                if (df > allowed) continue;
+                const float cost = df / allowed + std::abs(peak.db - prev[k].db) / max_db_step;
+                uint32_t bits;
+                std::memcpy(&bits, &cost, sizeof(bits));
+                candidates.push_back(static_cast<uint64_t>(bits) << 32 | i << 16 | k);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        static constexpr uint32_t none = UINT32_MAX;
+        matched.assign(n_peaks, none);
+        prev_taken.assign(n_prev, false);
+        size_t continued = 0;
+        for (uint64_t c : candidates)
+        {
+            const uint32_t i = (c >> 16) & 0xffff, k = c & 0xffff;
+            if (matched[i] != none || prev_taken[k]) continue;
+            matched[i] = k;
+            prev_taken[k] = true;
+            continued++;
+        }
+        died += n_prev - continued;
+        born += n_peaks - continued;
+
+        for (size_t i = 0; i < n_peaks; i++)
+        {
+            Point p{ peaks[i].frequency, peaks[i].db, 0, 0 };
+            if (matched[i] != none)
+            {
+                p.track = points[p0 + matched[i]].track;
+                p.prev = static_cast<uint32_t>(points.size() - (p0 + matched[i]));
+            }
+            else
+            {
+                p.track = next_track++;
+            }
+            points.push_back(p);
+        }
+        column_start.push_back(points.size());
+
+        // drop the older half once twice as many columns as needed are kept
+        if (columnCount() >= 2 * max_columns)
+        {
+            const size_t drop = columnCount() - max_columns;
+            const size_t offset = column_start[drop];
+            points.erase(points.begin(), points.begin() + offset);
+            column_start.erase(column_start.begin(), column_start.begin() + drop);
+            for (size_t& s : column_start) s -= offset;
+            // the oldest kept column continues nothing anymore
+            for (size_t i = 0; i < column_start[1]; i++) points[i].prev = 0;
+            first_column += drop;
+        }
+    }
+
+    // Calls f(first kept column, points, count) for the tracks with at least min_points points
+    // among the kept columns, by order of birth. Points are in column order.
+    template <typename F>
+    void forEachTrack(size_t min_points, F&& f) const
+    {
+        std::vector<uint32_t> order(points.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&](uint32_t a, uint32_t b) { return points[a].track < points[b].track; });
+        std::vector<Point> track;
+        for (size_t i = 0; i < order.size();)
+        {
+            size_t j = i;
+            track.clear();
+            while (j < order.size() && points[order[j]].track == points[order[i]].track)
+                track.push_back(points[order[j++]]);
+            if (track.size() >= min_points)
+            {
+                const size_t column = std::upper_bound(column_start.begin(), column_start.end(), order[i]) - column_start.begin() - 1;
+                f(column, track.data(), track.size());
+            }
+            i = j;
+        }
+    }
+};
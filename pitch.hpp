@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "acf.hpp"
+
+// Monophonic pitch by the McLeod pitch method: normalised square difference of the last
+// window_size samples, estimated every hop_size samples. The autocorrelation comes from the
+// power spectrum of the zero padded window, the period is the first key maximum within
+// `cutoff` of the highest one and clarity is its height, 1 for a perfectly periodic input.
+// An estimate describes the window ending at the last sample fed, so latency is one window.
+struct PitchTracker {
+    float sampleRate = 48000.0f;
+    float min_frequency = 50.0f;
+    float max_frequency = 2000.0f;
+    double cutoff = 0.93;
+    uint32_t window_size = 0;
+    uint32_t hop_size = 0;
+
+    std::vector<double> input;
+    std::vector<double> frame;
+    Autocorrelation autocorrelation;
+    std::vector<double> nsdf;
+    // samples in `input` so far and since the last estimate
+    size_t filled = 0;
+    size_t pending = 0;
+
+    float frequency = 0.0f;
+    float clarity = 0.0f;
+
+    // the window holds two periods of min_frequency, rounded up to a power of two
+    void init(float _sampleRate)
+    {
+        sampleRate = _sampleRate;
+        window_size = 64;
+        while (window_size < 2.0f * sampleRate / min_frequency) window_size *= 2;
+        hop_size = window_size / 4;
+        input.assign(window_size, 0.0);
+        frame.resize(window_size);
+        autocorrelation.init(window_size);
+        nsdf.resize(window_size / 2 + 2);
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(input.begin(), input.end(), 0.0);
+        filled = 0;
+        pending = 0;
+        frequency = 0.0f;
+        clarity = 0.0f;
+    }
+
+    // Fractional MIDI note of the current estimate
+    float note() const { return frequency > 0.0f ? 12.0f * std::log2(frequency / 440.0f) + 69.0f : 0.0f; }
+
+    // Returns how many estimates were made, the last one is in frequency / clarity
+    size_t feed(const float* data, size_t length)
+    {
+        size_t estimates = 0;
+        while (length > 0)
+        {
+            const size_t take = std::min(length, hop_size - pending);
+            std::copy(input.begin() + take, input.end(), input.begin());
+            std::copy(data, data + take, input.end() - take);
+            data += take;
+            length -= take;
+            filled = std::min<size_t>(filled + take, window_size);
+            pending += take;
+            if (pending == hop_size)
+            {
+                pending = 0;
+                if (filled == window_size)
+                {
+                    analyze();
+                    estimates++;
+                }
+            }
+        }
+        return estimates;
+    }
+
+    void analyze()
+    {
+        const size_t n = window_size;
+        double mean = 0.0;
+        for (size_t i = 0; i < n; i++) mean += input[i];
+        mean /= n;
+
+        double energy = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            frame[i] = input[i] - mean;
+            energy += frame[i] * frame[i];
+        }
+        if (energy < 1e-10 * n)
+        {
+            frequency = 0.0f;
+            clarity = 0.0f;
+            return;
+        }
+
+        const std::vector<double>& acf = autocorrelation.compute(frame.data(), n);
+
+        // m(tau) = sum of x[j]^2 + x[j + tau]^2 over the overlap, shrinking one pair per lag
+        const size_t max_tau = std::min<size_t>(n / 2, static_cast<size_t>(std::ceil(sampleRate / min_frequency)));
+        const size_t min_tau = std::max<size_t>(2, static_cast<size_t>(sampleRate / max_frequency));
+        double m = 2.0 * energy;
+        nsdf[0] = 1.0;
+        for (size_t tau = 1; tau <= max_tau + 1; tau++)
+        {
+            m -= frame[tau - 1] * frame[tau - 1] + frame[n - tau] * frame[n - tau];
+            nsdf[tau] = m > 0.0 ? 2.0 * acf[tau] / m : 0.0;
+        }
+
+        // key maxima: the highest point between each positive going zero crossing and the next
+        // negative going one, past the lobe around lag 0
+        static constexpr size_t max_peaks = 64;
+        size_t peaks[max_peaks];
+        size_t n_peaks = 0;
+        size_t tau = 1;
+        while (tau < max_tau && nsdf[tau] > 0.0) tau++;
+        size_t best = 0;
+        for (; tau < max_tau && n_peaks < max_peaks; tau++)
+        {
+            if (nsdf[tau] > 0.0)
+            {
+                if (best == 0 || nsdf[tau] > nsdf[best]) best = tau;
+            }
+            else if (best != 0)
+            {
+                if (best >= min_tau) peaks[n_peaks++] = best;
+                best = 0;
+            }
+        }
+        if (best >= min_tau && n_peaks < max_peaks) peaks[n_peaks++] = best;
+
+        double highest = 0.0;
+        for (size_t p = 0; p < n_peaks; p++) highest = std::max(highest, nsdf[peaks[p]]);
+        if (n_peaks == 0 || highest <= 0.0)
+        {
+            frequency = 0.0f;
+            clarity = 0.0f;
+            return;
+        }
+
+        size_t period = peaks[0];
+        for (size_t p = 0; p < n_peaks; p++)
+        {
+            if (nsdf[peaks[p]] >= cutoff * highest)
+            {
+                period = peaks[p];
+                break;
+            }
+        }
+
+        // parabola through the peak and its neighbours
+        const double y0 = nsdf[period - 1];
+        const double y1 = nsdf[period];
+        const double y2 = nsdf[period + 1];
+        const double den = y0 - 2.0 * y1 + y2;
+        const double offset = den < 0.0 ? std::clamp(0.5 * (y0 - y2) / den, -0.5, 0.5) : 0.0;
+        frequency = static_cast<float>(sampleRate / (period + offset));
+        clarity = static_cast<float>(std::clamp(y1 - 0.25 * (y0 - y2) * offset, 0.0, 1.0));
+    }
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+// pocketfft.h with the plan cache every header shares: plans for the last few lengths are kept
+// instead of rebuilt for every frame. The size is fixed per binary, so nothing includes
+// pocketfft.h directly.
+#ifndef POCKETFFT_CACHE_SIZE
+#define POCKETFFT_CACHE_SIZE 16
+#endif
+#include "pocketfft.h"
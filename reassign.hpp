@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+enum PhaseDerivative {
+    kDeriveOff = 0,
+    kDeriveFrequency,
+    kDeriveDelay,
+    kDeriveReassign,
+    kDeriveCount
+};
+
+// x wrapped into [-pi, pi] by taking out the nearest multiple of 2 pi
+static inline simde__m256 principal_arg(simde__m256 x)
+{
+    const simde__m256 turns = simde_mm256_round_ps(simde_mm256_mul_ps(x, simde_mm256_set1_ps(0.5f / M_PI)),
+                                                   SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC);
+    return simde_mm256_sub_ps(x, simde_mm256_mul_ps(turns, simde_mm256_set1_ps(2.0f * M_PI)));
+}
+
+static inline simde__m256d principal_arg(simde__m256d x)
+{
+    const simde__m256d turns = simde_mm256_round_pd(simde_mm256_mul_pd(x, simde_mm256_set1_pd(0.5 / M_PI)),
+                                                    SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC);
+    return simde_mm256_sub_pd(x, simde_mm256_mul_pd(turns, simde_mm256_set1_pd(2.0 * M_PI)));
+}
+
+static inline double principal_arg(double x)
+{
+    return x - 2.0 * M_PI * std::nearbyint(x * 0.5 / M_PI);
+}
+
+// Instantaneous frequency as a deviation from the bin centre: the phase advance of every bin
+// since the previous frame, less the advance of the bin centre over a hop (`advance`, wrapped),
+// wrapped and scaled to bins by bins_per_radian (window / (2 pi hop))
+void instantaneous_frequency(const float * phase, const float * prev, const float * advance, float * out,
+                             unsigned n, float bins_per_radian)
+{
+    const simde__m256 scale = simde_mm256_set1_ps(bins_per_radian);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 d = simde_mm256_sub_ps(simde_mm256_loadu_ps(&phase[i]), simde_mm256_loadu_ps(&prev[i]));
+        d = principal_arg(simde_mm256_sub_ps(d, simde_mm256_loadu_ps(&advance[i])));
+        simde_mm256_storeu_ps(&out[i], simde_mm256_mul_ps(d, scale));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = principal_arg(phase[k] - prev[k] - advance[k]) * bins_per_radian;
+    }
+}
+
+void instantaneous_frequency(const double * phase, const double * prev, const double * advance, float * out,
+                             unsigned n, float bins_per_radian)
+{
+    const simde__m256d scale = simde_mm256_set1_pd(bins_per_radian);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d d = simde_mm256_sub_pd(simde_mm256_loadu_pd(&phase[i]), simde_mm256_loadu_pd(&prev[i]));
+        d = principal_arg(simde_mm256_sub_pd(d, simde_mm256_loadu_pd(&advance[i])));
+        simde_mm_storeu_ps(&out[i], simde_mm256_cvtpd_ps(simde_mm256_mul_pd(d, scale)));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        out[k] = principal_arg(phase[k] - prev[k] - advance[k]) * bins_per_radian;
+    }
+}
+
+// Group delay from the phase slope across bins, central difference over two bins: the frame
+// centre is a phase step of 2 pi, so the wrapped step scaled by samples_per_radian
+// (-window / (4 pi)) is the delay from the centre. The first and last bins read 0.
+void group_delay(const float * phase, float * out, unsigned n, float samples_per_radian)
+{
+    if (n < 3)
+    {
+        std::fill(out, out + n, 0.0f);
+        return;
+    }
+    const simde__m256 scale = simde_mm256_set1_ps(samples_per_radian);
+    const unsigned m = n - 2;
+    unsigned i;
+    for (i = 0; i < m - m % 8; i += 8)
+    {
+        simde__m256 d = simde_mm256_sub_ps(simde_mm256_loadu_ps(&phase[i + 2]), simde_mm256_loadu_ps(&phase[i]));
+        simde_mm256_storeu_ps(&out[i + 1], simde_mm256_mul_ps(principal_arg(d), scale));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < m; k++)
+    {
+        out[k + 1] = principal_arg(phase[k + 2] - phase[k]) * samples_per_radian;
+    }
+    out[0] = 0.0f;
+    out[n - 1] = 0.0f;
+}
+
+void group_delay(const double * phase, float * out, unsigned n, float samples_per_radian)
+{
+    if (n < 3)
+    {
+        std::fill(out, out + n, 0.0f);
+        return;
+    }
+    const simde__m256d scale = simde_mm256_set1_pd(samples_per_radian);
+    const unsigned m = n - 2;
+    unsigned i;
+    for (i = 0; i < m - m % 4; i += 4)
+    {
+        simde__m256d d = simde_mm256_sub_pd(simde_mm256_loadu_pd(&phase[i + 2]), simde_mm256_loadu_pd(&phase[i]));
+        simde_mm_storeu_ps(&out[i + 1], simde_mm256_cvtpd_ps(simde_mm256_mul_pd(principal_arg(d), scale)));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < m; k++)
+    {
+        out[k + 1] = principal_arg(phase[k + 2] - phase[k]) * samples_per_radian;
+    }
+    out[0] = 0.0f;
+    out[n - 1] = 0.0f;
+}
+
+// Frequency reassignment: the power of bin k moves to bin k + deviation[k], split linearly
+// between the two nearest bins, bins holds the square root of what lands in each afterwards.
+// power is scratch of n values.
+template <typename T>
+void reassign_frequency(T * bins, const float * deviation, T * power, unsigned n)
+{
+    if (n < 2) return;
+    std::fill(power, power + n, T(0));
+    for (unsigned k = 0; k < n; k++)
+    {
+        const float at = k + deviation[k];
+        if (!(at >= 0.0f) || at > n - 1) continue;
+        const unsigned lo = std::min(static_cast<unsigned>(at), n - 2);
+        const T t = at - lo;
+        const T p = bins[k] * bins[k];
+        power[lo] += p * (1 - t);
+        power[lo + 1] += p * t;
+    }
+    for (unsigned k = 0; k < n; k++)
+    {
+        bins[k] = std::sqrt(power[k]);
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+// Sliding DFT bank: up to 8 arbitrary frequencies, one per SIMD lane, updated every sample.
+// Each track runs three resonators (f - 1 bin, f, f + 1 bin) so a Hann window can be applied
+// in the frequency domain. Resonators are slightly damped to keep float rounding from
+// accumulating, which tapers the rectangular window by r^N (~1% at 1024).
+struct SlidingDFT {
+    static constexpr int max_tracks = 8;
+    static constexpr float damping = 0.99999f;
+
+    float sampleRate;
+    uint32_t window_size;
+    uint32_t decimation;
+
+    int n_tracks = 0;
+    float frequencies[max_tracks];
+
+    // X[n] = A X[n-1] + B x[n-N] + C x[n], per resonator and lane
+    alignas(32) float a_re[3][max_tracks], a_im[3][max_tracks];
+    alignas(32) float b_re[3][max_tracks], b_im[3][max_tracks];
+    alignas(32) float c_re[3][max_tracks], c_im[3][max_tracks];
+    alignas(32) float x_re[3][max_tracks], x_im[3][max_tracks];
+
+    std::vector<float> history;
+    size_t history_pos;
+    uint32_t countdown;
+
+    // envelopes, rings of envelope_size values per track, envelope_pos is the oldest
+    size_t envelope_size;
+    size_t envelope_pos;
+    std::vector<float> magnitude[max_tracks];
+    std::vector<float> phase[max_tracks];
+
+    void init(float _sampleRate, uint32_t _window_size, uint32_t _decimation, size_t _envelope_size)
+    {
+        sampleRate = _sampleRate;
+        window_size = _window_size;
+        decimation = std::max(1u, _decimation);
+        envelope_size = _envelope_size;
+        for (int k = 0; k < max_tracks; k++)
+        {
+            magnitude[k].assign(envelope_size, 0.0f);
+            phase[k].assign(envelope_size, 0.0f);
+        }
+        envelope_pos = 0;
+        setFrequencies(frequencies, n_tracks);
+    }
+
+    void setFrequencies(const float* f, int n)
+    {
+        n_tracks = std::min(n, max_tracks);
+        std::copy(f, f + n_tracks, frequencies);
+
+        const double rN = std::pow(static_cast<double>(damping), window_size);
+        for (int r = 0; r < 3; r++)
+        {
+            for (int k = 0; k < max_tracks; k++)
+            {
+                double w = k < n_tracks ? 2 * M_PI * frequencies[k] / sampleRate : 0.0;
+                w += (r - 1) * 2 * M_PI / window_size;
+                a_re[r][k] = damping * std::cos(w);
+                a_im[r][k] = damping * std::sin(w);
+                b_re[r][k] = -rN * std::cos(w);
+                b_im[r][k] = -rN * std::sin(w);
+                c_re[r][k] = std::cos(w * (window_size - 1));
+                c_im[r][k] = -std::sin(w * (window_size - 1));
+                x_re[r][k] = 0.0f;
+                x_im[r][k] = 0.0f;
+            }
+        }
+        history.assign(window_size, 0.0f);
+        history_pos = 0;
+        countdown = decimation;
+    }
+
+    void process(const float* data, size_t length)
+    {
+        if (n_tracks == 0) return;
+
+        simde__m256 a_r[3], a_i[3], b_r[3], b_i[3], c_r[3], c_i[3], s_r[3], s_i[3];
+        for (int r = 0; r < 3; r++)
+        {
+            a_r[r] = simde_mm256_load_ps(a_re[r]); a_i[r] = simde_mm256_load_ps(a_im[r]);
+            b_r[r] = simde_mm256_load_ps(b_re[r]); b_i[r] = simde_mm256_load_ps(b_im[r]);
+            c_r[r] = simde_mm256_load_ps(c_re[r]); c_i[r] = simde_mm256_load_ps(c_im[r]);
+            s_r[r] = simde_mm256_load_ps(x_re[r]); s_i[r] = simde_mm256_load_ps(x_im[r]);
+        }
+
+        for (size_t i = 0; i < length; i++)
+        {
+            const simde__m256 xn = simde_mm256_set1_ps(data[i]);
+            const simde__m256 xo = simde_mm256_set1_ps(history[history_pos]);
+            history[history_pos] = data[i];
+            if (++history_pos == window_size) history_pos = 0;
+
+            for (int r = 0; r < 3; r++)
+            {
+                simde__m256 re = simde_mm256_sub_ps(simde_mm256_mul_ps(a_r[r], s_r[r]), simde_mm256_mul_ps(a_i[r], s_i[r]));
+                simde__m256 im = simde_mm256_add_ps(simde_mm256_mul_ps(a_r[r], s_i[r]), simde_mm256_mul_ps(a_i[r], s_r[r]));
+                re = simde_mm256_add_ps(re, simde_mm256_add_ps(simde_mm256_mul_ps(b_r[r], xo), simde_mm256_mul_ps(c_r[r], xn)));
+                im = simde_mm256_add_ps(im, simde_mm256_add_ps(simde_mm256_mul_ps(b_i[r], xo), simde_mm256_mul_ps(c_i[r], xn)));
+                s_r[r] = re;
+                s_i[r] = im;
+            }
+
+            if (--countdown == 0) {
+                countdown = decimation;
+                // Hann: 0.5 X(f) - 0.25 X(f - 1 bin) - 0.25 X(f + 1 bin), scaled so a sine reads its amplitude
+                const simde__m256 half = simde_mm256_set1_ps(0.5f);
+                const simde__m256 quarter = simde_mm256_set1_ps(0.25f);
+                const simde__m256 norm = simde_mm256_set1_ps(4.0f / window_size);
+                simde__m256 h_r = simde_mm256_sub_ps(simde_mm256_mul_ps(half, s_r[1]), simde_mm256_mul_ps(quarter, simde_mm256_add_ps(s_r[0], s_r[2])));
+                simde__m256 h_i = simde_mm256_sub_ps(simde_mm256_mul_ps(half, s_i[1]), simde_mm256_mul_ps(quarter, simde_mm256_add_ps(s_i[0], s_i[2])));
+                h_r = simde_mm256_mul_ps(h_r, norm);
+                h_i = simde_mm256_mul_ps(h_i, norm);
+                alignas(32) float lanes_r[max_tracks], lanes_i[max_tracks];
+                simde_mm256_store_ps(lanes_r, h_r);
+                simde_mm256_store_ps(lanes_i, h_i);
+                for (int k = 0; k < n_tracks; k++)
+                {
+                    magnitude[k][envelope_pos] = std::sqrt(lanes_r[k] * lanes_r[k] + lanes_i[k] * lanes_i[k]);
+                    phase[k][envelope_pos] = std::atan2(lanes_i[k], lanes_r[k]);
+                }
+                if (++envelope_pos == envelope_size) envelope_pos = 0;
+            }
+        }
+
+        for (int r = 0; r < 3; r++)
+        {
+            simde_mm256_store_ps(x_re[r], s_r[r]);
+            simde_mm256_store_ps(x_im[r], s_i[r]);
+        }
+    }
+
+    // i = 0 is the oldest value
+    float magnitudeAt(int track, size_t i) const { return magnitude[track][(envelope_pos + i) % envelope_size]; }
+    float phaseAt(int track, size_t i) const { return phase[track][(envelope_pos + i) % envelope_size]; }
+};
@@ -0,0 +1,41 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "fft.hpp"
+
+// Time per column with and without the spectral descriptors, float and double engines
+template <typename T>
+double run(const std::vector<T>& signal, uint32_t window_size, bool describing)
+{
+    Columns<T> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = 48000;
+    cols.describing = describing;
+    cols.init(&cached_hann<T>(window_size), window_size, window_size / 4);
+    std::vector<T> input(signal);
+
+    auto start = std::chrono::steady_clock::now();
+    auto n_columns = cols.feed(input.data(), input.size());
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / n_columns;
+}
+
+int main(void)
+{
+    const int length = 48000 * 20;
+    std::mt19937 rng(1);
+    std::normal_distribution<double> dist(0.0, 0.1);
+    std::vector<float> signal(length);
+    for (auto& v : signal) v = dist(rng);
+    std::vector<double> signal_d(signal.begin(), signal.end());
+
+    for (uint32_t window_size : { 1024, 4096, 16384 }) {
+        // warm up the plan cache first
+        run(signal, window_size, false);
+        const double off = run(signal, window_size, false), on = run(signal, window_size, true);
+        const double off_d = run(signal_d, window_size, false), on_d = run(signal_d, window_size, true);
+        printf("%5u: float %8.2fus -> %8.2fus (+%4.1f%%), double %8.2fus -> %8.2fus (+%4.1f%%)\n", window_size,
+               off, on, 100 * (on / off - 1), off_d, on_d, 100 * (on_d / off_d - 1));
+    }
+}
@@ -0,0 +1,36 @@
+#include <chrono>
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Time per column for power of two lengths against the mixed radix lengths used by the
+// millisecond presets at 44.1kHz and 48kHz, plus a prime length that goes through Bluestein
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 10;
+    std::vector<float> signal(length);
+    for (int j = 0; j < length; j++) {
+        signal[j] = 0.5f * std::sin(2 * M_PI * 3000.0 * j / sampleRate);
+    }
+
+    const int sizes[] = { 441, 480, 512, 882, 960, 1009, 1024, 1764, 1920, 2048, 2205, 2400, 4096, 4410, 4800, 8192 };
+    for (int window_size : sizes) {
+        Columns<float> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.init(&cached_hann<float>(window_size), window_size, window_size / 4);
+
+        auto start = std::chrono::steady_clock::now();
+        auto n_columns = cols.feed(signal.data(), length);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        const auto& last = cols.columns.back();
+        printf("%5d: %6d columns, %8.2fus/column, %8.2fns/sample, peak %fHz @ %f\n",
+               window_size, n_columns, elapsed / n_columns, elapsed * 1000 / n_columns / window_size,
+               last.peakFrequency, last.peakMagnitude);
+    }
+}
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+#include "history.hpp"
+#include "workers.hpp"
+
+// Re-analysis of 60 seconds of history in chunks of 8 frames, serial then on 1 to 16 pool
+// threads, every run has to match the serial columns exactly
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 60;
+    AudioHistory history;
+    history.init(length);
+    std::vector<float> block(4800);
+    for (int j = 0; j < length; j += block.size()) {
+        for (size_t k = 0; k < block.size(); k++) {
+            double t = static_cast<double>(j + k) / sampleRate;
+            block[k] = 0.5f * std::sin(2 * M_PI * (200.0 + 100.0 * t) * t) + 0.01f * std::sin(2 * M_PI * 7000.0 * t);
+        }
+        history.write(block.data(), block.size());
+    }
+
+    const uint32_t N = 4096, hop = 1024;
+    const size_t chunk = 8;
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(N), N, hop);
+    const size_t frames = (history.end() - history.begin() - N) / hop + 1;
+    const size_t chunks = (frames + chunk - 1) / chunk;
+
+    struct Worker {
+        Columns<float>::Scratch scratch;
+        std::vector<float> frame;
+    };
+    auto analyzeChunk = [&](std::vector<Columns<float>::Column>& out, size_t c, Worker& w) {
+        w.frame.resize(N);
+        const size_t hi = frames - c * chunk;
+        const size_t lo = hi > chunk ? hi - chunk : 0;
+        for (size_t f = hi; f-- > lo;) {
+            history.read(static_cast<uint64_t>(f) * hop, w.frame.data(), N);
+            cols.analyze(w.frame.data(), out[f], w.scratch);
+        }
+    };
+
+    std::vector<Columns<float>::Column> reference(frames, Columns<float>::Column(cols.outputSize()));
+    Worker serial;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < chunks; c++) analyzeChunk(reference, c, serial);
+    const double serial_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%zu frames of %u, serial: %.1fms (%u hardware threads)\n", frames, N, serial_ms, std::thread::hardware_concurrency());
+
+    for (size_t n_threads : { 1, 2, 4, 8, 16 }) {
+        WorkerPool pool;
+        pool.start(n_threads);
+        std::vector<Worker> workers(pool.size());
+        std::vector<Columns<float>::Column> out(frames, Columns<float>::Column(cols.outputSize()));
+
+        start = std::chrono::steady_clock::now();
+        pool.submit(chunks, [&](size_t c, size_t w) { analyzeChunk(out, c, workers[w]); });
+        while (pool.busy()) std::this_thread::yield();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        float worst = 0.0f;
+        for (size_t f = 0; f < frames; f++) {
+            for (size_t i = 0; i < out[f].size; i++) worst = std::max(worst, std::abs(out[f].bins[i] - reference[f].bins[i]));
+        }
+        printf("%2zu threads: %7.1fms, speedup %5.2f, max difference %g\n", n_threads, ms, serial_ms / ms, worst);
+    }
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Quefrency bin of the largest cepstrum value from min_bin on, over the mean of all the columns,
+// refined with a parabola
+template <typename T>
+double cepstrum_peak(const Columns<T>& cols, size_t min_bin, double& prominence)
+{
+    std::vector<double> mean(cols.columns[0].size, 0.0);
+    for (const auto& col : cols.columns)
+        for (size_t q = 0; q < mean.size(); q++) mean[q] += col.bins[q] / cols.columns.size();
+    size_t best = min_bin;
+    for (size_t q = min_bin; q + 1 < mean.size(); q++)
+        if (mean[q] > mean[best]) best = q;
+    std::vector<double> sorted(mean.begin() + min_bin, mean.end());
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    prominence = 20.0 * std::log10(mean[best] / sorted[sorted.size() / 2]);
+    const double y0 = mean[best - 1], y1 = mean[best], y2 = mean[best + 1];
+    const double d = y0 - 2.0 * y1 + y2;
+    return best + (d < 0.0 ? std::clamp(0.5 * (y0 - y2) / d, -0.5, 0.5) : 0.0);
+}
+
+// White noise with an echo at a few delays and gains, then harmonic tones at a few pitches, the
+// cepstrum peak against the true delay or period. Last, the cost of the inverse transform per
+// column against the plain STFT column.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 2;
+    const float lifter_seconds = 0.001f;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> dry(length);
+    for (auto& v : dry) v = noise(rng);
+
+    for (float delay_ms : { 2.5f, 7.3f, 20.0f }) {
+        for (float gain : { 0.5f, 0.2f }) {
+            const int delay = std::lround(delay_ms * sampleRate / 1000.0f);
+            std::vector<float> x(dry);
+            for (int j = delay; j < length; j++) x[j] += gain * dry[j - delay];
+            Columns<float> cols;
+            cols.fct = 2.0;
+            cols.sampleRate = sampleRate;
+            cols.cepstral = true;
+            cols.lifter_seconds = lifter_seconds;
+            cols.init(&cached_hann<float>(4096), 4096, 4096 / 2);
+            cols.feed(x.data(), length);
+            double prominence;
+            const double q = cepstrum_peak(cols, 1, prominence);
+            printf("echo %5.1fms gain %.1f: peak at %7.3fms, %.1fdB over the median\n", delay_ms, gain,
+                   1000.0 * q / sampleRate, prominence);
+        }
+    }
+
+    for (float f0 : { 110.0f, 220.0f, 440.0f }) {
+        std::vector<double> x(length, 0.0);
+        for (int h = 1; f0 * h < sampleRate / 2; h++)
+            for (int j = 0; j < length; j++) x[j] += 0.1 / h * std::sin(2 * M_PI * f0 * h * j / sampleRate);
+        Columns<double> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.cepstral = true;
+        cols.lifter_seconds = lifter_seconds;
+        cols.init(&cached_hann<double>(4096), 4096, 4096 / 2);
+        cols.feed(x.data(), length);
+        double prominence;
+        const double q = cepstrum_peak(cols, 1, prominence);
+        printf("tone %5.1fHz: peak at %7.3fms, %.2fHz, %.1fdB over the median, column peak %.2fHz\n", f0,
+               1000.0 * q / sampleRate, sampleRate / q, prominence, cols.columns.back().peakFrequency);
+    }
+
+    for (int fft_size : { 512, 2048, 8192 }) {
+        Columns<float> stft, cepstrum;
+        stft.fct = 2.0;
+        stft.sampleRate = sampleRate;
+        stft.init(&cached_hann<float>(fft_size), fft_size, fft_size);
+        cepstrum.fct = 2.0;
+        cepstrum.sampleRate = sampleRate;
+        cepstrum.cepstral = true;
+        cepstrum.lifter_seconds = lifter_seconds;
+        cepstrum.init(&cached_hann<float>(fft_size), fft_size, fft_size / 2);
+        Columns<float>::Column col(stft.outputSize());
+        Columns<float>::Scratch scratch;
+        const int iterations = 4000000 / fft_size;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) stft.computeColumn(dry.data() + (i % 64) * 16, col, scratch);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) cepstrum.computeColumn(dry.data() + (i % 64) * 16, col, scratch);
+        auto t2 = std::chrono::steady_clock::now();
+        const double stft_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+        const double cepstrum_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations;
+        printf("%5d: STFT %.2fus, cepstrum %.2fus per column (+%.0f%%)\n", fft_size, stft_us, cepstrum_us,
+               100.0 * (cepstrum_us - stft_us) / stft_us);
+    }
+}
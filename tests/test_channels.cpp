@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "channels.hpp"
+
+// Matrix modes against a scalar reference on a length that leaves a remainder, then mid and
+// side summed back to left and right
+int main(void)
+{
+    const size_t length = 4803;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> l(length), r(length), first(length), second(length);
+    for (size_t j = 0; j < length; j++) {
+        l[j] = dist(rng);
+        r[j] = dist(rng);
+    }
+
+    static const char* names[kChannelsCount] = { "L / R", "M / S", "L", "R", "M", "S", "Matrix" };
+    const float custom[4] = { 0.7f, -0.3f, 1.5f, 0.25f };
+    for (int mode = 0; mode < kChannelsCount; mode++) {
+        ChannelMatrix m;
+        m.set(static_cast<ChannelMode>(mode), custom);
+        m.apply(l.data(), r.data(), first.data(), second.data(), length);
+        float worst = 0.0f;
+        for (size_t j = 0; j < length; j++) {
+            worst = std::max(worst, std::abs(first[j] - (m.a * l[j] + m.b * r[j])));
+            if (!m.single) worst = std::max(worst, std::abs(second[j] - (m.c * l[j] + m.d * r[j])));
+        }
+        printf("%-6s: single %d, max difference %g\n", names[mode], m.single, worst);
+    }
+
+    ChannelMatrix ms;
+    ms.set(kChannelsMS, custom);
+    ms.apply(l.data(), r.data(), first.data(), second.data(), length);
+    float worst = 0.0f;
+    for (size_t j = 0; j < length; j++) {
+        worst = std::max(worst, std::abs(first[j] + second[j] - l[j]));
+        worst = std::max(worst, std::abs(first[j] - second[j] - r[j]));
+    }
+    printf("M + S, M - S vs L, R: max difference %g\n", worst);
+}
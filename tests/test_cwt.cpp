@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Scale of the loudest bin of a column, refined with a parabola on the dB
+template <typename C>
+double peak_scale(const C& col)
+{
+    const int k = std::clamp(col.peakBin, 1, static_cast<int>(col.size) - 2);
+    const double y0 = col.bins_db[k - 1], y1 = col.bins_db[k], y2 = col.bins_db[k + 1];
+    const double d = y0 - 2.0 * y1 + y2;
+    return k + (d < 0.0 ? std::clamp(0.5 * (y0 - y2) / d, -0.5, 0.5) : 0.0);
+}
+
+// Columns either side of the loudest one in row `bin` within 6dB of it
+template <typename T>
+int columns_within_6db(const Columns<T>& cols, size_t bin, size_t& loudest)
+{
+    loudest = 0;
+    for (size_t c = 0; c < cols.columns.size(); c++)
+        if (cols.columns[c].bins_db[bin] > cols.columns[loudest].bins_db[bin]) loudest = c;
+    int width = 0;
+    for (const auto& col : cols.columns)
+        if (col.bins_db[bin] > cols.columns[loudest].bins_db[bin] - 6.0f) width++;
+    return width;
+}
+
+// Tones across the range: level and frequency read from the loudest scale, interpolated on the
+// log grid, float and double engines. A click in silence: its column and how many columns it
+// smears over in a low, a middle and a high row. Last, the cost of a second of audio against
+// real time at a few supports, hops and scale counts, on one thread and on four.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 2;
+    const int window_size = 8192;
+    const int hop_size = 256;
+
+    for (double f : { 100.0, 440.0, 1234.5, 5000.0, 12000.0 }) {
+        std::vector<float> x(length);
+        std::vector<double> x_d(length);
+        for (int j = 0; j < length; j++) x_d[j] = x[j] = 0.5 * std::sin(2 * M_PI * f * j / sampleRate);
+        Columns<float> cols;
+        Columns<double> cols_d;
+        cols.sampleRate = sampleRate;
+        cols.columns_memory_size = 1 << 20;
+        cols.init(&cached_hann<float>(window_size), window_size, hop_size);
+        cols.setScalogram(true, 128);
+        cols_d.sampleRate = sampleRate;
+        cols_d.columns_memory_size = 1 << 20;
+        cols_d.init(&cached_hann<double>(window_size), window_size, hop_size);
+        cols_d.setScalogram(true, 128);
+        cols.feed(x.data(), length);
+        cols_d.feed(x_d.data(), length);
+        const auto& col = cols.columns.back();
+        const auto& col_d = cols_d.columns.back();
+        const double s = peak_scale(col), s_d = peak_scale(col_d);
+        const auto& c = cols.cwt.centers;
+        auto at = [&](double s) {
+            const size_t k = std::min<size_t>(s, c.size() - 2);
+            return c[k] * std::pow(c[k + 1] / c[k], s - k);
+        };
+        printf("tone %7.1fHz amplitude 0.5: %.3f, float %.2fHz, double %.2fHz\n", f,
+               static_cast<double>(col.bins[col.peakBin]), at(s), at(s_d));
+    }
+
+    {
+        std::vector<float> x(length, 0.0f);
+        const int click = length / 2 + 100;
+        x[click] = 1.0f;
+        Columns<float> cols;
+        cols.sampleRate = sampleRate;
+        cols.columns_memory_size = 1 << 20;
+        cols.init(&cached_hann<float>(window_size), window_size, hop_size);
+        cols.setScalogram(true, 128);
+        cols.feed(x.data(), length);
+        for (size_t bin : { size_t(8), size_t(64), size_t(120) }) {
+            size_t loudest;
+            const int width = columns_within_6db(cols, bin, loudest);
+            printf("click at column %.2f, %7.1fHz row: loudest column %zu, %d columns within 6dB (%.1fms)\n",
+                   static_cast<double>(click) / hop_size, cols.frequencyAt(bin), loudest, width,
+                   1000.0 * width * hop_size / sampleRate);
+        }
+        printf("support %u samples, block %u, %zu columns per block\n", cols.cwt.support, cols.cwt.block_size,
+               cols.cwt.columnsPerBlock());
+    }
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> x(sampleRate * 4);
+    for (auto& v : x) v = noise(rng);
+    printf("%u cores\n", std::thread::hardware_concurrency());
+    for (int size : { 8192, 32768 }) {
+        for (int hop : { 256, 64 }) {
+            for (unsigned scales : { 64, 256 }) {
+                double ms[2];
+                for (unsigned threads : { 1, 4 }) {
+                    WorkerPool pool;
+                    pool.start(threads);
+                    Columns<float> cols;
+                    cols.sampleRate = sampleRate;
+                    cols.scale_pool = &pool;
+                    cols.columns_memory_size = 1 << 20;
+                    cols.init(&cached_hann<float>(size), size, hop);
+                    cols.setScalogram(true, scales);
+                    cols.feed(x.data(), sampleRate);
+                    auto t0 = std::chrono::steady_clock::now();
+                    cols.feed(x.data() + sampleRate, x.size() - sampleRate);
+                    auto t1 = std::chrono::steady_clock::now();
+                    ms[threads > 1] = std::chrono::duration<double, std::milli>(t1 - t0).count() / 3;
+                }
+                printf("support %5d hop %3d, %3u scales: %.2fms per second of audio on 1 thread (%.2f%% of real time), %.2fms on 4\n",
+                       size, hop, scales, ms[0], ms[0] / 10.0, ms[1]);
+            }
+        }
+    }
+}
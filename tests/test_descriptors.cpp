@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Descriptors of a sine and of white noise against the textbook values, and the SIMD sums
+// against plain double loops over the same column
+template <typename T>
+void compare(const typename Columns<T>::Column& col, float df, const char* name)
+{
+    double s0 = 0, s1 = 0, s2 = 0, sp = 0, sln = 0, splog = 0, mx = 0;
+    for (size_t k = 0; k < col.size; k++) {
+        const double m = col.bins[k], f = k * df, p = m * m;
+        s0 += m;
+        s1 += f * m;
+        s2 += f * f * m;
+        sp += p;
+        sln += std::log(std::max(p, 1e-40));
+        splog += p > 0 ? p * std::log2(p) : 0.0;
+        mx = std::max(mx, m);
+    }
+    const double centroid = s1 / s0;
+    const double spread = std::sqrt(s2 / s0 - centroid * centroid);
+    const double flatness = std::exp(sln / col.size) / (sp / col.size);
+    const double entropy = (std::log2(sp) - splog / sp) / std::log2(static_cast<double>(col.size));
+    const auto& d = col.descriptors;
+    printf("%s: centroid %.2f/%.2fHz spread %.2f/%.2fHz flatness %.4f/%.4f crest %.2f/%.2f entropy %.4f/%.4f\n", name,
+           d.centroid, centroid, d.spread, spread, d.flatness, flatness, d.crest, mx * col.size / s0, d.entropy, entropy);
+    printf("%s: rolloff 85%% %.1fHz, 95%% %.1fHz, flux %.5f\n", name, d.rolloff85, d.rolloff95, d.flux);
+}
+
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int window_size = 4096;
+    const int length = sampleRate * 2;
+    std::vector<float> sine(length), noise(length);
+    std::vector<double> noise_d(length);
+    std::mt19937 rng(1);
+    std::normal_distribution<double> dist(0.0, 0.1);
+    for (int j = 0; j < length; j++) {
+        sine[j] = 0.5f * std::sin(2 * M_PI * 3000.0 * j / sampleRate);
+        noise_d[j] = dist(rng);
+        noise[j] = noise_d[j];
+    }
+
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.describing = true;
+    cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols.feed(sine.data(), length);
+    compare<float>(cols.columns.back(), cols.frequencyAt(1), "sine");
+
+    cols.columns.clear();
+    cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols.feed(noise.data(), length);
+    compare<float>(cols.columns.back(), cols.frequencyAt(1), "noise");
+
+    Columns<double> precise;
+    precise.fct = 2.0;
+    precise.sampleRate = sampleRate;
+    precise.describing = true;
+    precise.init(&cached_hann<double>(window_size), window_size, window_size / 2);
+    precise.feed(noise_d.data(), length);
+    compare<double>(precise.columns.back(), precise.frequencyAt(1), "noise, double");
+
+    // a step from silence to noise shows up in the flux of the first column that sees it
+    std::vector<float> step(length, 0.0f);
+    std::copy(noise.begin() + length / 2, noise.end(), step.begin() + length / 2);
+    cols.columns.clear();
+    cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols.feed(step.data(), length);
+    int onset = -1;
+    for (size_t i = 0; i < cols.columns.size(); i++) {
+        if (onset < 0 && cols.columns[i].descriptors.flux > 0.01f) onset = i;
+    }
+    printf("step at %d: first column with flux %d (covers %d..%d)\n", length / 2, onset,
+           onset * window_size / 2, onset * window_size / 2 + window_size);
+}
@@ -14,7 +14,7 @@ int main(void)
     window.resize(window_size);
     hann(window.data(), window_size, false);
 
-    Columns cols;
+    Columns<float> cols;
     cols.fct = 2.0;
     cols.sampleRate = 48000;
     cols.init(&window, window_size);
@@ -30,4 +30,58 @@ int main(void)
         printf("%d - %d -> %fHz @ %f\n", i, cols.columns[i].peakBin, cols.columns[i].peakFrequency, cols.columns[i].peakMagnitude);
     }
     
+
+    Columns<float> multires;
+    multires.fct = 2.0;
+    multires.sampleRate = 48000;
+    multires.init(&window, window_size, window_size / 2);
+    multires.setMultiResolution(true);
+
+    n_columns = multires.feed(sine_3khz, 48000);
+    printf("multi-resolution processed: %d (%zu extra resolutions)\n", n_columns, multires.resolutions.size());
+
+    for (int i = 0; i < n_columns; i++) {
+        printf("%d - %d -> %fHz @ %f\n", i, multires.columns[i].peakBin, multires.columns[i].peakFrequency, multires.columns[i].peakMagnitude);
+    }
+
+    // clicks between the frame centres at hop = window: the short windows step through the whole
+    // hop, so the high band of every column still sees its click
+    std::vector<float> clicks(48000, 0.0f);
+    for (int j = window_size / 4; j < 48000; j += window_size) clicks[j] = 1.0f;
+    Columns<float> transient;
+    transient.fct = 2.0;
+    transient.sampleRate = 48000;
+    transient.init(&window, window_size);
+    transient.setMultiResolution(true);
+    n_columns = transient.feed(clicks.data(), 48000);
+    for (int i = 0; i < 4; i++) {
+        printf("click column %d: %fdB @ 12kHz\n", i, transient.columns[i].bins_db[256]);
+    }
+
+    // same analysis in double precision, highest bin away from the peak shows the noise floor
+    std::vector<double> window_d(window_size);
+    hann(window_d.data(), window_size, false);
+    std::vector<double> sine_d(sine_3khz, sine_3khz + 48000);
+
+    Columns<double> precise;
+    precise.fct = 2.0;
+    precise.sampleRate = 48000;
+    precise.init(&window_d, window_size);
+    n_columns = precise.feed(sine_d.data(), 48000);
+    printf("double processed: %d\n", n_columns);
+
+    auto floor_f = 0.0f;
+    auto floor_d = 0.0;
+    for (int j = 0; j < window_size / 2 + 1; j++) {
+        if (std::abs(j - 64) < 8) continue;
+        floor_f = std::max(floor_f, cols.columns[0].bins[j]);
+        floor_d = std::max(floor_d, precise.columns[0].bins[j]);
+    }
+    printf("double: %d -> %fHz @ %f\n", precise.columns[0].peakBin, precise.columns[0].peakFrequency, precise.columns[0].peakMagnitude);
+    printf("noise floor float: %.1fdB double: %.1fdB\n", 20 * std::log10(floor_f), 20 * std::log10(floor_d));
+
+    // dB stage against std::log10 on the peak bin
+    printf("peak dB: float %fdB (bins_db %fdB) double %fdB (bins_db %fdB)\n",
+           20 * std::log10(cols.columns[0].bins[64]), cols.columns[0].bins_db[64],
+           20 * std::log10(precise.columns[0].bins[64]), precise.columns[0].bins_db[64]);
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+#include "tests/sine_3khz.hpp"
+
+int main(void)
+{
+    auto window_size = 1024;
+    std::vector<float> window;
+    window.resize(window_size);
+    hann(window.data(), window_size, false);
+
+    const char* names[3] = { "mel", "bark", "erb" };
+    for (int scale = kScaleMel; scale <= kScaleERB; scale++) {
+        Filterbank bank;
+        bank.init(static_cast<FilterbankScale>(scale), 40, window_size, 48000);
+
+        Columns<float> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = 48000;
+        cols.filterbank = &bank;
+        cols.init(&window, window_size);
+
+        auto n_columns = cols.feed(sine_3khz, 48000);
+        printf("%s: %zu bands, %zu weights, processed: %d\n", names[scale], bank.size(), bank.weights.size(), n_columns);
+        printf("%s: peak band %d -> %fHz @ %f\n", names[scale], cols.columns[0].peakBin, cols.columns[0].peakFrequency, cols.columns[0].peakMagnitude);
+    }
+}
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Delays a noise signal by whole and fractional amounts in the frequency domain and
+// estimates them back from the spectra of streamed frames, plus unrelated noise on both sides
+int main(void)
+{
+    const int sampleRate = 48000;
+    const size_t length = 1 << 19;
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 0.1);
+    std::vector<double> x(length);
+    for (auto& v : x) v = noise(rng);
+
+    // circular fractional delay of x by d samples
+    std::vector<std::complex<double>> spectrum(length / 2 + 1);
+    pocketfft::r2c({length}, {sizeof(double)}, {sizeof(std::complex<double>)}, 0, pocketfft::FORWARD, x.data(), spectrum.data(), 1.0);
+    auto delayed = [&](double d) {
+        std::vector<std::complex<double>> shifted(spectrum.size());
+        for (size_t k = 0; k < spectrum.size(); k++) shifted[k] = spectrum[k] * std::polar(1.0, -2 * M_PI * k * d / length);
+        // the Nyquist bin of a real signal stays real
+        shifted.back() = std::real(shifted.back());
+        std::vector<double> y(length);
+        pocketfft::c2r({length}, {sizeof(std::complex<double>)}, {sizeof(double)}, 0, pocketfft::BACKWARD, shifted.data(), y.data(), 1.0 / length);
+        return y;
+    };
+
+    const uint32_t window_size = 4096;
+    auto measure = [&](const std::vector<double>& a, const std::vector<double>& b, double& delay, double& confidence) {
+        Columns<float> cols_a, cols_b;
+        for (auto* cols : { &cols_a, &cols_b }) {
+            cols->fct = 2.0;
+            cols->sampleRate = sampleRate;
+            cols->init(&cached_hann<float>(window_size), window_size, window_size / 2);
+            cols->keep_spectra = true;
+        }
+        DelayEstimator estimator;
+        estimator.init(window_size);
+        std::vector<float> block_a(4800), block_b(4800);
+        for (size_t j = 0; j + 4800 <= length; j += 4800) {
+            for (size_t k = 0; k < 4800; k++) {
+                block_a[k] = a[j + k];
+                block_b[k] = b[j + k];
+            }
+            cols_a.feed(block_a.data(), 4800);
+            cols_b.feed(block_b.data(), 4800);
+            for (size_t at = 0; at < cols_a.spectra.size(); at += estimator.size())
+                estimator.accumulate(cols_a.spectra.data() + at, cols_b.spectra.data() + at);
+            cols_a.spectra.clear();
+            cols_b.spectra.clear();
+        }
+        estimator.estimate(delay, confidence);
+        return estimator.frames;
+    };
+
+    for (double d : { 0.0, 37.0, -120.0, 12.3, -5.75, 0.5 }) {
+        auto y = delayed(d);
+        // a bit of noise on the delayed side
+        for (auto& v : y) v += 0.3 * noise(rng);
+        double delay, confidence;
+        auto frames = measure(x, y, delay, confidence);
+        printf("delay %7.2f: estimated %8.3f, error %6.3f, confidence %.3f (%llu frames)\n", d, delay, delay - d, confidence,
+               static_cast<unsigned long long>(frames));
+    }
+
+    std::vector<double> unrelated(length);
+    for (auto& v : unrelated) v = noise(rng);
+    double delay, confidence;
+    measure(x, unrelated, delay, confidence);
+    printf("unrelated: estimated %8.3f, confidence %.3f\n", delay, confidence);
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Harmonic tones, one with a weak and one with a missing fundamental, through the STFT with
+// the harmonic sum on, the f0 of the last column against the true one. Then noise, and the
+// SIMD candidate search against the scalar one on the same column.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int window_size = 4096;
+    const int length = sampleRate;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.harmonics = true;
+
+    auto run = [&](auto&& gain, float f0, const char* name) {
+        std::vector<float> x(length);
+        for (int j = 0; j < length; j++) {
+            float v = 0.0f;
+            for (int h = 1; h <= 10; h++) v += gain(h) * std::sin(2 * M_PI * h * f0 * j / sampleRate);
+            x[j] = 0.2f * v + noise(rng);
+        }
+        cols.columns.clear();
+        cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+        cols.feed(x.data(), length);
+        const auto& hs = cols.columns.back().harmonic;
+        printf("%s %7.2f: f0 %7.2f, error %6.2f cents, salience %5.1f dB, bins", name, f0, hs.f0,
+               hs.f0 > 0 ? 1200.0f * std::log2(hs.f0 / f0) : 0.0f, hs.salience);
+        for (unsigned h = 0; h < cols.n_harmonics; h++) printf(" %d", hs.bins[h]);
+        printf("\n");
+    };
+
+    for (float f0 : { 61.7f, 110.0f, 196.0f, 440.0f, 1234.5f })
+        run([](int h) { return 1.0f / h; }, f0, "harmonic");
+    run([](int h) { return h == 1 ? 0.02f : 1.0f / h; }, 146.8f, "weak fundamental");
+    run([](int h) { return h == 1 ? 0.0f : 1.0f / h; }, 200.0f, "missing fundamental");
+    run([](int h) { return h % 2 ? 1.0f / h : 0.0f; }, 330.0f, "odd harmonics");
+
+    std::vector<float> white(length);
+    std::normal_distribution<float> loud(0.0f, 0.1f);
+    for (auto& v : white) v = loud(rng);
+    cols.columns.clear();
+    cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols.feed(white.data(), length);
+    const auto& col = cols.columns.back();
+    printf("noise: f0 %7.2f, salience %5.1f dB\n", col.harmonic.f0, col.harmonic.salience);
+
+    const unsigned k_hi = col.size / cols.n_harmonics;
+    const float floor = *std::max_element(col.bins_db.begin(), col.bins_db.end()) - 80.0f;
+    float best;
+    const int iterations = 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    unsigned peak = 0;
+    for (int i = 0; i < iterations; i++) peak = harmonic_sum_peak(col.bins_db.data(), 1, k_hi, cols.n_harmonics, floor, best);
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned scalar_peak = 1;
+    float scalar_best = -INFINITY;
+    for (int i = 0; i < iterations; i++) {
+        scalar_best = -INFINITY;
+        for (unsigned k = 1; k < k_hi; k++) {
+            float sum = 0.0f;
+            for (unsigned h = 1; h <= cols.n_harmonics; h++)
+                sum += std::max(floor, *std::max_element(&col.bins_db[h * k], &col.bins_db[h * k + h]));
+            if (sum > scalar_best) { scalar_best = sum; scalar_peak = k; }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    printf("candidate search: simd bin %u (%.3f) %.2fus, scalar bin %u (%.3f) %.2fus\n",
+           peak, best, std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations,
+           scalar_peak, scalar_best, std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations);
+}
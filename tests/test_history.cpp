@@ -0,0 +1,78 @@
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+#include "history.hpp"
+
+int main(void)
+{
+    // chirp from 100Hz to 10kHz over 4 seconds, stored in a 3 second history
+    const int sampleRate = 48000;
+    const int length = sampleRate * 4;
+    std::vector<float> signal(length);
+    for (int j = 0; j < length; j++) {
+        double t = static_cast<double>(j) / sampleRate;
+        signal[j] = 0.5f * std::sin(2 * M_PI * (100.0 * t + (10000.0 - 100.0) / 8.0 * t * t));
+    }
+
+    AudioHistory history;
+    history.init(sampleRate * 3);
+    for (int j = 0; j < length; j += 1000) history.write(signal.data() + j, std::min(1000, length - j));
+    printf("history: %llu to %llu\n", static_cast<unsigned long long>(history.begin()), static_cast<unsigned long long>(history.end()));
+
+    // reference: the whole signal streamed at 2048 / 512
+    const uint32_t N = 2048, hop = 512;
+    Columns<float> stream;
+    stream.fct = 2.0;
+    stream.sampleRate = sampleRate;
+    stream.init(&cached_hann<float>(N), N, hop);
+    stream.setMultiResolution(true);
+    stream.feed(signal.data(), length);
+
+    // same frames rebuilt from the history, ending on the last complete frame
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(N), N, hop);
+    cols.setMultiResolution(true);
+    const size_t frames = (history.end() - history.begin() - N) / hop + 1;
+    const uint64_t first = history.end() - N - (frames - 1) * hop;
+    Columns<float>::Scratch scratch;
+    std::vector<float> frame(N);
+    cols.columns.assign(frames, Columns<float>::Column(cols.outputSize()));
+    for (size_t f = frames; f-- > 0;) {
+        history.read(first + f * hop, frame.data(), N);
+        cols.analyze(frame.data(), cols.columns[f], scratch);
+    }
+    printf("reanalysed: %zu frames from %llu\n", frames, static_cast<unsigned long long>(first));
+
+    // streamed frame k starts at k * hop, compare the overlapping ones
+    float worst = 0.0f;
+    int compared = 0;
+    for (size_t f = 0; f < frames; f++) {
+        uint64_t pos = first + f * hop;
+        if (pos % hop != 0 || pos / hop >= stream.columns.size()) continue;
+        const auto& a = stream.columns[pos / hop];
+        const auto& b = cols.columns[f];
+        for (size_t i = 0; i < a.size; i++) worst = std::max(worst, std::abs(a.bins[i] - b.bins[i]));
+        compared++;
+    }
+    printf("compared %d frames, max difference %g\n", compared, worst);
+
+    // feeding from one hop after the stored frames continues the stream where it would have been
+    const uint64_t next = first + frames * hop;
+    cols.feed(signal.data() + next, history.end() - next);
+    std::vector<float> more(sampleRate);
+    for (int j = 0; j < sampleRate; j++) more[j] = 0.25f * std::sin(2 * M_PI * 440.0 * j / sampleRate);
+    int n = cols.feed(more.data(), more.size());
+    stream.feed(more.data(), more.size());
+    worst = 0.0f;
+    for (int k = 1; k <= n; k++) {
+        const auto& a = stream.columns[stream.columns.size() - k];
+        const auto& b = cols.columns[cols.columns.size() - k];
+        for (size_t i = 0; i < a.size; i++) worst = std::max(worst, std::abs(a.bins[i] - b.bins[i]));
+    }
+    printf("resumed: %d frames, max difference %g\n", n, worst);
+}
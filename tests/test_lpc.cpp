@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Impulse train at f0 through a cascade of two-pole resonators, one per formant
+std::vector<double> vowel(int sampleRate, int length, double f0, const double* formants, const double* bandwidths, int n)
+{
+    std::vector<double> x(length, 0.0);
+    const int period = std::lround(sampleRate / f0);
+    for (int j = 0; j < length; j += period) x[j] = 1.0;
+    for (int f = 0; f < n; f++) {
+        const double r = std::exp(-M_PI * bandwidths[f] / sampleRate);
+        const double a1 = 2 * r * std::cos(2 * M_PI * formants[f] / sampleRate), a2 = -r * r;
+        double y1 = 0.0, y2 = 0.0;
+        for (auto& v : x) {
+            const double y = (1 - a1 - a2) * v + a1 * y1 + a2 * y2;
+            y2 = y1;
+            y1 = y;
+            v = y;
+        }
+    }
+    return x;
+}
+
+// Levinson-Durbin against the coefficients of a known AR(4) process. Then two synthetic vowels
+// at a few orders: the formants found in the newest column against the resonators, and the
+// envelope against the column's own bins at the harmonics near F1. Last, the cost of the
+// prediction per column against the plain STFT column.
+int main(void)
+{
+    {
+        const double truth[5] = { 1.0, -2.7607, 3.8106, -2.6535, 0.9238 };
+        std::mt19937 rng(1);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        const int length = 1 << 18;
+        std::vector<double> x(length, 0.0);
+        for (int j = 4; j < length; j++)
+            x[j] = noise(rng) - truth[1] * x[j - 1] - truth[2] * x[j - 2] - truth[3] * x[j - 3] - truth[4] * x[j - 4];
+        double r[5], a[5];
+        for (int k = 0; k < 5; k++) {
+            r[k] = 0.0;
+            for (int j = k; j < length; j++) r[k] += x[j] * x[j - k];
+            r[k] /= length;
+        }
+        const double error = levinson_durbin(r, 4, a);
+        printf("AR(4):");
+        for (int k = 1; k < 5; k++) printf(" %.4f (%.4f)", a[k], truth[k]);
+        printf(", error %.3f (1)\n", error);
+    }
+
+    const int sampleRate = 48000;
+    const int length = sampleRate / 2;
+    const double formants_a[3] = { 730, 1090, 2440 }, bandwidths_a[3] = { 80, 90, 120 };
+    const double formants_i[3] = { 270, 2290, 3010 }, bandwidths_i[3] = { 60, 100, 120 };
+    struct { const char* name; const double* f; const double* b; double f0; } vowels[] = {
+        { "/a/ 110Hz", formants_a, bandwidths_a, 110.0 },
+        { "/i/ 220Hz", formants_i, bandwidths_i, 220.0 },
+    };
+    for (const auto& v : vowels) {
+        std::vector<double> x = vowel(sampleRate, length, v.f0, v.f, v.b, 3);
+        printf("%s, formants %.0f %.0f %.0fHz\n", v.name, v.f[0], v.f[1], v.f[2]);
+        for (unsigned order : { 16, 32, 48 }) {
+            Columns<double> cols;
+            cols.fct = 2.0;
+            cols.sampleRate = sampleRate;
+            cols.lpc_order = order;
+            cols.init(&cached_hann<double>(2048), 2048, 2048 / 2);
+            cols.feed(x.data(), length);
+            const auto& col = cols.columns.back();
+            printf("  order %2u:", order);
+            for (unsigned f = 0; f < col.lpc.n_formants; f++) printf(" %.0f (%.0f)", col.lpc.formants[f], col.lpc.bandwidths[f]);
+            // the harmonics within 300Hz of F1, envelope less bins
+            float omega[8], env[8];
+            int bins[8], n = 0;
+            for (int h = 1; n < 8; h++) {
+                const double f = h * v.f0;
+                if (f > v.f[0] + 300) break;
+                if (f < v.f[0] - 300) continue;
+                bins[n] = std::lround(f * 2048 / sampleRate);
+                omega[n] = 2 * M_PI * bins[n] / 2048;
+                n++;
+            }
+            lpc_envelope_db(col.lpc, omega, env, n);
+            double diff = 0.0;
+            for (int k = 0; k < n; k++) diff += env[k] - col.bins_db[bins[k]];
+            printf(" | envelope %+.1fdB over the harmonics around F1\n", diff / n);
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> dry(sampleRate);
+    for (auto& v : dry) v = noise(rng);
+    for (int fft_size : { 512, 2048, 8192 }) {
+        Columns<float> stft, lpc;
+        stft.fct = 2.0;
+        stft.sampleRate = sampleRate;
+        stft.init(&cached_hann<float>(fft_size), fft_size, fft_size / 2);
+        lpc.fct = 2.0;
+        lpc.sampleRate = sampleRate;
+        lpc.lpc_order = 48;
+        lpc.init(&cached_hann<float>(fft_size), fft_size, fft_size / 2);
+        Columns<float>::Column col(stft.outputSize());
+        Columns<float>::Scratch scratch;
+        // the best of a few interleaved rounds, so a busy machine doesn't favour either
+        const int iterations = 1000000 / fft_size;
+        double stft_us = 1e9, lpc_us = 1e9;
+        for (int round = 0; round < 5; round++) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) stft.computeColumn(dry.data() + (i % 64) * 16, col, scratch);
+            auto t1 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) lpc.computeColumn(dry.data() + (i % 64) * 16, col, scratch);
+            auto t2 = std::chrono::steady_clock::now();
+            stft_us = std::min(stft_us, std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations);
+            lpc_us = std::min(lpc_us, std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations);
+        }
+        printf("%5d: STFT %.2fus, with order 48 prediction %.2fus per column (+%.0f%%)\n", fft_size, stft_us, lpc_us,
+               100.0 * (lpc_us - stft_us) / stft_us);
+    }
+}
@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// White noise with a tone switching on and off every half second, stepping up 20 dB at 4 s and
+// back down at 8 s. The floor's median over the bins against the mean level of the noise alone,
+// at a few points in time and for a few hop sizes, and the share of noise and tone bins the gate
+// lets through. Last, the cost per column on both channels at a small hop against the FFT.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 12;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    std::vector<float> x(length), noise_only(length);
+    const float tone_hz = 3000.0f;
+    for (int j = 0; j < length; j++) {
+        const float t = static_cast<float>(j) / sampleRate;
+        const float gain = (t >= 4.0f && t < 8.0f) ? 0.01f : 0.001f;
+        noise_only[j] = gain * noise(rng);
+        const bool tone = static_cast<int>(2 * t) % 2 == 0;
+        x[j] = noise_only[j] + (tone ? 0.1f * std::sin(2 * M_PI * tone_hz * j / sampleRate) : 0.0f);
+    }
+
+    for (int window_size : { 512, 2048, 8192 }) {
+        for (int overlap : { 2, 8 }) {
+            const int hop_size = window_size / overlap;
+            // mean level of the noise alone per bin, before and during the step
+            Columns<float> reference;
+            reference.fct = 2.0;
+            reference.sampleRate = sampleRate;
+            reference.columns_memory_size = length;
+            reference.init(&cached_hann<float>(window_size), window_size, hop_size);
+            reference.feed(noise_only.data(), length);
+            const float cps = 1.0f / reference.secondsPerColumn();
+            auto mean_db = [&](float from, float to) {
+                std::vector<double> power(reference.columns[0].size, 0.0);
+                size_t count = 0;
+                for (size_t c = from * cps; c < std::min<size_t>(to * cps, reference.columns.size()); c++, count++)
+                    for (size_t k = 0; k < power.size(); k++) power[k] += std::pow(10.0, reference.columns[c].bins_db[k] / 10.0);
+                std::vector<float> db(power.size());
+                for (size_t k = 0; k < power.size(); k++) db[k] = 10.0 * std::log10(power[k] / count);
+                return db;
+            };
+            const std::vector<float> quiet = mean_db(1.0f, 4.0f), loud = mean_db(5.0f, 8.0f);
+
+            Columns<float> cols;
+            cols.fct = 2.0;
+            cols.sampleRate = sampleRate;
+            cols.init(&cached_hann<float>(window_size), window_size, hop_size);
+            cols.flooring = kFloorGate;
+            printf("window %5d hop %4d:", window_size, hop_size);
+            const int block = sampleRate / 100;
+            size_t noise_bins = 0, noise_passed = 0, tone_cols = 0, tone_passed = 0;
+            const size_t tone_bin = static_cast<size_t>(std::lround(tone_hz * window_size / sampleRate));
+            for (int j = 0; j + block <= length; j += block) {
+                const int n = cols.feed(x.data() + j, block);
+                const float t = static_cast<float>(j + block) / sampleRate;
+                for (int i = 0; i < n; i++) {
+                    const auto& col = cols.columns[cols.columns.size() - n + i];
+                    if (t < 2.0f || (t > 3.9f && t < 6.0f) || t > 7.9f) continue;
+                    for (size_t k = 1; k + 1 < col.size; k++) {
+                        if (k + 4 >= tone_bin && k <= tone_bin + 4) continue;
+                        noise_bins++;
+                        noise_passed += col.bins_db[k] > -400.0f;
+                    }
+                    const float phase = std::fmod(2.0f * t, 2.0f);
+                    if (phase > 0.3f && phase < 0.9f) {
+                        tone_cols++;
+                        tone_passed += col.bins_db[tone_bin] > -400.0f;
+                    }
+                }
+                for (float at : { 3.9f, 4.5f, 5.5f, 7.9f, 8.2f, 9.0f, 11.9f }) {
+                    if (j < at * sampleRate && j + block >= at * sampleRate) {
+                        const auto& floor = cols.noise_floor.floor;
+                        const auto& truth = (at > 4.0f && at < 8.0f) ? loud : quiet;
+                        std::vector<float> error(floor.size() - 2);
+                        for (size_t k = 1; k + 1 < floor.size(); k++) error[k - 1] = floor[k] - truth[k];
+                        std::nth_element(error.begin(), error.begin() + error.size() / 2, error.end());
+                        printf(" %4.1fs %+5.1f", at, error[error.size() / 2]);
+                    }
+                }
+            }
+            printf(" dB | gate passes %.1f%% of noise, %.1f%% of tone\n",
+                   100.0 * noise_passed / noise_bins, 100.0 * tone_passed / tone_cols);
+        }
+    }
+
+    // both channels at a 512 window and 64 hop
+    const int fft_size = 512;
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(fft_size), fft_size, fft_size / 8);
+    cols.flooring = kFloorGate;
+    std::vector<float> frame(fft_size);
+    for (auto& v : frame) v = noise(rng);
+    Columns<float>::Column col(cols.outputSize()), col_r(cols.outputSize());
+    Columns<float>::Scratch scratch;
+    cols.analyze(frame.data(), col, scratch);
+    cols.analyze(frame.data(), col_r, scratch);
+    NoiseFloor floor_r = cols.noise_floor;
+    const int iterations = 20000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) cols.computeColumn(frame.data(), col, scratch);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        cols.applyFloor(col);
+        std::swap(cols.noise_floor, floor_r);
+        cols.applyFloor(col_r);
+        std::swap(cols.noise_floor, floor_r);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    const double fft_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+    const double floor_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations;
+    printf("per column: FFT %.2fus, floor on both channels %.3fus (%.1f%% of one FFT)\n", fft_us, floor_us, 100.0 * floor_us / fft_us);
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Decaying noise bursts over quiet noise at a steady tempo, with a little timing jitter. The
+// column stream goes through the log flux, the detector and the tempo estimator the way the
+// view does, onsets are refined on the samples and matched against where the bursts start.
+// Last, the cost of the per column work against the FFT of the column.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int window_size = 2048;
+    const int hop_size = 512;
+    const int length = sampleRate * 12;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_int_distribution<int> jitter(-300, 300);
+
+    for (float tempo : { 120.0f, 97.0f, 143.0f }) {
+        std::vector<float> x(length);
+        for (auto& v : x) v = 0.002f * noise(rng);
+        std::vector<size_t> hits;
+        const size_t beat = static_cast<size_t>(60.0f * sampleRate / tempo);
+        for (size_t at = 7001; at + sampleRate / 4 < static_cast<size_t>(length); at += beat) {
+            const size_t start = at + jitter(rng);
+            hits.push_back(start);
+            for (size_t j = 0; j < sampleRate / 4; j++)
+                x[start + j] += 0.5f * std::exp(-static_cast<float>(j) / (0.03f * sampleRate)) * noise(rng);
+        }
+
+        Columns<float> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.init(&cached_hann<float>(window_size), window_size, hop_size);
+        const float cps = 1.0f / cols.secondsPerColumn();
+
+        OnsetDetector detector;
+        detector.init(std::max(1, static_cast<int>(0.03f * cps)), static_cast<int>(0.1f * cps));
+        TempoEstimator tempo_estimator;
+        tempo_estimator.init(cps, 8.0f);
+
+        std::vector<size_t> found;
+        for (int j = 0; j + 4800 <= length; j += 4800) {
+            int n = cols.feed(x.data() + j, 4800);
+            for (int i = 0; i < n; i++) {
+                const size_t c = cols.columns.size() - n + i;
+                if (c == 0) continue;
+                const float odf = log_flux(cols.columns[c].bins_db.data(), cols.columns[c - 1].bins_db.data(), cols.columns[c].size, -100.0f);
+                uint64_t onset;
+                if (detector.push(odf, onset)) {
+                    // the first column has no flux, so detector index k is column k + 1: its
+                    // frame and a hop either side, in stream samples
+                    const size_t start = (onset + 1) * hop_size;
+                    const size_t lo = start - hop_size;
+                    const size_t hi = std::min<size_t>(start + window_size + hop_size, j + 4800);
+                    found.push_back(lo + refine_onset(x.data() + lo, hi - lo, 64));
+                }
+                tempo_estimator.push(odf);
+            }
+        }
+
+        size_t matched = 0;
+        double error = 0.0, worst = 0.0;
+        for (size_t hit : hits) {
+            auto it = std::min_element(found.begin(), found.end(), [&](size_t a, size_t b) {
+                return std::abs(static_cast<double>(a) - hit) < std::abs(static_cast<double>(b) - hit);
+            });
+            if (it == found.end()) continue;
+            const double e = std::abs(static_cast<double>(*it) - hit);
+            if (e > window_size) continue;
+            matched++;
+            error += e;
+            worst = std::max(worst, e);
+        }
+        printf("tempo %6.1f: %zu hits, %zu onsets, %zu matched, mean error %.1f samples (worst %.0f), tempo %.1f BPM (%.2f)\n",
+               tempo, hits.size(), found.size(), matched, matched ? error / matched : 0.0, worst,
+               tempo_estimator.bpm, tempo_estimator.confidence);
+    }
+
+    // per column cost with a 4096 window at a quarter window hop
+    const int fft_size = 4096;
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(fft_size), fft_size, fft_size / 4);
+    std::vector<float> frame(fft_size);
+    for (auto& v : frame) v = noise(rng);
+    Columns<float>::Column col(cols.outputSize()), prev(cols.outputSize());
+    Columns<float>::Scratch scratch;
+    cols.analyze(frame.data(), prev, scratch);
+    const float cps = 1.0f / cols.secondsPerColumn();
+    OnsetDetector detector;
+    detector.init(std::max(1, static_cast<int>(0.03f * cps)), static_cast<int>(0.1f * cps));
+    TempoEstimator tempo_estimator;
+    tempo_estimator.init(cps, 8.0f);
+
+    const int iterations = 4000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) cols.computeColumn(frame.data(), col, scratch);
+    auto t1 = std::chrono::steady_clock::now();
+    cols.finishColumn(col);
+    float sink = 0.0f;
+    for (int i = 0; i < iterations; i++) {
+        const float odf = log_flux(col.bins_db.data(), prev.bins_db.data(), col.size, -100.0f);
+        uint64_t onset;
+        sink += detector.push(odf + (i % 7 == 0), onset);
+        tempo_estimator.push(odf);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    const double fft_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+    const double onset_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations;
+    printf("per column: FFT %.2fus, onsets and tempo %.3fus (%.2f%%) %g\n", fft_us, onset_us, 100.0 * onset_us / fft_us, sink * 0.0);
+}
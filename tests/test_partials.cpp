@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+#include "partials.hpp"
+
+// A steady tone, a rising glide and a tone with vibrato over quiet noise, through an 8192
+// window at 75% overlap: the longest track near each one and its worst frequency error against
+// the true one. Then the matching cost per column against the number of peaks, random peaks
+// with no relation from one column to the next, the worst case for the sort.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int window_size = 8192;
+    const int hop_size = window_size / 4;
+    const int length = sampleRate * 4;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.001f);
+
+    auto steady = [](double) { return 440.0; };
+    auto glide = [](double t) { return 1000.0 * std::pow(2.0, t / 4.0); };
+    auto vibrato = [](double t) { return 2000.0 + 20.0 * std::sin(2 * M_PI * 1.5 * t); };
+    const std::vector<std::function<double(double)>> partials = { steady, glide, vibrato };
+
+    std::vector<float> x(length);
+    for (auto& v : x) v = noise(rng);
+    for (const auto& f : partials) {
+        double phase = 0.0;
+        for (int j = 0; j < length; j++) {
+            x[j] += 0.2f * std::sin(phase);
+            phase += 2 * M_PI * f(static_cast<double>(j) / sampleRate) / sampleRate;
+        }
+    }
+
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(window_size), window_size, hop_size);
+    PartialTracker tracker;
+    tracker.init(1000, 2.0f * cols.frequencyAt(1));
+    std::vector<PartialPeak> peaks;
+    for (int j = 0; j + 4800 <= length; j += 4800) {
+        int n = cols.feed(x.data() + j, 4800);
+        for (int i = 0; i < n; i++) {
+            const auto& col = cols.columns[cols.columns.size() - n + i];
+            find_partial_peaks(col.bins_db.data(), col.bins_peak, col.size,
+                               [&](size_t k) { return cols.frequencyAt(k); }, 60.0f, 256, peaks);
+            tracker.push(peaks);
+        }
+    }
+    printf("%zu columns, %llu born, %llu died, %zu alive\n", tracker.columnCount(),
+           static_cast<unsigned long long>(tracker.born), static_cast<unsigned long long>(tracker.died), tracker.alive());
+
+    const char* names[] = { "steady", "glide", "vibrato" };
+    for (size_t p = 0; p < partials.size(); p++) {
+        size_t best_points = 0;
+        double best_error = 0.0;
+        tracker.forEachTrack(2, [&](size_t column, const PartialTracker::Point* points, size_t count) {
+            // the frame of column c is centred on c * hop + window / 2
+            double worst = 0.0;
+            for (size_t i = 0; i < count; i++) {
+                const double t = ((column + i) * hop_size + window_size / 2.0) / sampleRate;
+                worst = std::max(worst, std::abs(1200.0 * std::log2(points[i].frequency / partials[p](t))));
+            }
+            if (worst < 50.0 && count > best_points) {
+                best_points = count;
+                best_error = worst;
+            }
+        });
+        printf("%-8s: longest track %zu of %zu columns, worst error %.2f cents\n", names[p], best_points,
+               tracker.columnCount(), best_error);
+    }
+
+    // matching cost with random peaks, sorted by frequency
+    std::uniform_real_distribution<float> frequency(20.0f, 20000.0f), level(-80.0f, 0.0f);
+    for (size_t n : { 64, 256, 1024, 4096 }) {
+        std::vector<std::vector<PartialPeak>> frames(16);
+        for (auto& frame : frames) {
+            for (size_t i = 0; i < n; i++) frame.push_back({ frequency(rng), level(rng) });
+            std::sort(frame.begin(), frame.end(), [](const PartialPeak& a, const PartialPeak& b) { return a.frequency < b.frequency; });
+        }
+        PartialTracker bench;
+        bench.init(500, 2.0f * cols.frequencyAt(1));
+        // past the first trim of the arena, so it has all the memory it will use
+        for (int i = 0; i < 1000; i++) bench.push(frames[i % frames.size()]);
+        const int iterations = 2000;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) bench.push(frames[i % frames.size()]);
+        auto t1 = std::chrono::steady_clock::now();
+        const double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+        printf("%5zu peaks: %.2fus per column, %.1fns per peak\n", n, us, 1000.0 * us / n);
+    }
+}
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "pitch.hpp"
+
+// Harmonic tones with a bit of noise streamed in audio sized blocks, the estimate of the
+// last window against the true f0, then noise alone which should have low clarity
+int main(void)
+{
+    const float sampleRate = 48000.0f;
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.02f);
+
+    PitchTracker pitch;
+    pitch.init(sampleRate);
+    printf("window %u, hop %u\n", pitch.window_size, pitch.hop_size);
+
+    auto run = [&](auto&& sample, size_t length) {
+        pitch.reset();
+        std::vector<float> block(480);
+        size_t estimates = 0;
+        for (size_t j = 0; j < length; j += block.size()) {
+            for (size_t k = 0; k < block.size(); k++) block[k] = sample(j + k) + noise(rng);
+            estimates += pitch.feed(block.data(), block.size());
+        }
+        return estimates;
+    };
+
+    for (float f0 : { 55.0f, 82.41f, 110.0f, 220.5f, 440.0f, 1000.0f, 1760.0f }) {
+        // sawtooth-ish: harmonics at 1/h, the fundamental isn't always the strongest peak
+        auto tone = [&](size_t i) {
+            float v = 0.0f;
+            for (int h = 1; h <= 8 && h * f0 < sampleRate / 2; h++) v += std::sin(2 * M_PI * h * f0 * i / sampleRate) / h;
+            return 0.3f * v;
+        };
+        auto estimates = run(tone, 48000);
+        printf("f0 %8.2f: estimated %8.2f, error %6.2f cents, clarity %.3f, note %.2f (%zu estimates)\n", f0, pitch.frequency,
+               1200.0f * std::log2(pitch.frequency / f0), pitch.clarity, pitch.note(), estimates);
+    }
+
+    // a missing fundamental still gives the period
+    auto missing = [&](size_t i) {
+        float v = 0.0f;
+        for (int h = 2; h <= 6; h++) v += std::sin(2 * M_PI * h * 150.0 * i / sampleRate);
+        return 0.1f * v;
+    };
+    run(missing, 48000);
+    printf("missing fundamental 150: estimated %8.2f, clarity %.3f\n", pitch.frequency, pitch.clarity);
+
+    std::normal_distribution<float> loud(0.0f, 0.3f);
+    run([&](size_t) { return loud(rng); }, 48000);
+    printf("noise: estimated %8.2f, clarity %.3f\n", pitch.frequency, pitch.clarity);
+
+    run([](size_t) { return 0.0f; }, 48000);
+    printf("background noise alone: estimated %8.2f, clarity %.3f\n", pitch.frequency, pitch.clarity);
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// Bins of a column within range_db of its loudest one
+template <typename C>
+int bins_within(const C& col, float range_db)
+{
+    const float top = *std::max_element(col.bins_db.begin(), col.bins_db.end());
+    return std::count_if(col.bins_db.begin(), col.bins_db.end(), [&](float db) { return db > top - range_db; });
+}
+
+// A tone a third of a bin off the grid: its frequency read from the instantaneous frequency of
+// the loudest bin at a few overlaps, float and double engines. A click at a known distance from
+// the frame centre against the median group delay over the bins. The width of the tone's peak with
+// and without reassignment. Last, the cost of each against the FFT of a column.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int window_size = 2048;
+    const int length = sampleRate;
+    const double tone_hz = (100 + 1.0 / 3.0) * sampleRate / window_size;
+    std::vector<float> x(length);
+    std::vector<double> x_d(length);
+    for (int j = 0; j < length; j++) x_d[j] = x[j] = 0.5 * std::sin(2 * M_PI * tone_hz * j / sampleRate);
+
+    for (int overlap : { 2, 4, 8 }) {
+        Columns<float> cols;
+        Columns<double> cols_d;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.deriving = kDeriveFrequency;
+        cols.init(&cached_hann<float>(window_size), window_size, window_size / overlap);
+        cols_d.fct = 2.0;
+        cols_d.sampleRate = sampleRate;
+        cols_d.deriving = kDeriveFrequency;
+        cols_d.init(&cached_hann<double>(window_size), window_size, window_size / overlap);
+        cols.feed(x.data(), length);
+        cols_d.feed(x_d.data(), length);
+        const auto& col = cols.columns.back();
+        const auto& col_d = cols_d.columns.back();
+        const double f = cols.frequencyAt(col.peakBin) + col.bins_deviation[col.peakBin] * cols.frequencyAt(1);
+        const double f_d = cols_d.frequencyAt(col_d.peakBin) + col_d.bins_deviation[col_d.peakBin] * cols_d.frequencyAt(1);
+        printf("overlap %d: tone %.4fHz, float %.4fHz, double %.4fHz\n", overlap, tone_hz, f, f_d);
+    }
+
+    for (int offset : { -400, -100, 0, 37, 250 }) {
+        std::vector<float> frame(window_size, 0.0f);
+        frame[window_size / 2 + offset] = 1.0f;
+        Columns<float> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.deriving = kDeriveDelay;
+        cols.init(&cached_hann<float>(window_size), window_size, window_size / 4);
+        Columns<float>::Column col(cols.outputSize());
+        Columns<float>::Scratch scratch;
+        cols.computeColumn(frame.data(), col, scratch);
+        cols.derivePhase(col, nullptr);
+        std::vector<float> delays(col.bins_deviation.begin() + 1, col.bins_deviation.end() - 1);
+        std::nth_element(delays.begin(), delays.begin() + delays.size() / 2, delays.end());
+        printf("click %+4d samples from the centre: group delay %+.2f samples\n", offset, delays[delays.size() / 2]);
+    }
+
+    {
+        Columns<float> plain, sharp;
+        plain.fct = 2.0;
+        plain.sampleRate = sampleRate;
+        plain.init(&cached_hann<float>(window_size), window_size, window_size / 4);
+        sharp.fct = 2.0;
+        sharp.sampleRate = sampleRate;
+        sharp.deriving = kDeriveReassign;
+        sharp.init(&cached_hann<float>(window_size), window_size, window_size / 4);
+        plain.feed(x.data(), length);
+        sharp.feed(x.data(), length);
+        printf("bins within 20dB of the peak: STFT %d, reassigned %d; within 40dB: %d, %d\n",
+               bins_within(plain.columns.back(), 20.0f), bins_within(sharp.columns.back(), 20.0f),
+               bins_within(plain.columns.back(), 40.0f), bins_within(sharp.columns.back(), 40.0f));
+    }
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    for (int fft_size : { 512, 2048, 8192 }) {
+        std::vector<float> frame(fft_size);
+        for (auto& v : frame) v = noise(rng);
+        Columns<float> cols;
+        cols.fct = 2.0;
+        cols.sampleRate = sampleRate;
+        cols.deriving = kDeriveFrequency;
+        cols.init(&cached_hann<float>(fft_size), fft_size, fft_size / 4);
+        Columns<float>::Column col(cols.outputSize()), prev(cols.outputSize());
+        Columns<float>::Scratch scratch;
+        cols.computeColumn(frame.data(), prev, scratch);
+        prev.processed = true;
+        const int iterations = 4000000 / fft_size;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) cols.computeColumn(frame.data(), col, scratch);
+        auto t1 = std::chrono::steady_clock::now();
+        double us[kDeriveCount];
+        us[kDeriveOff] = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+        for (int d = kDeriveFrequency; d < kDeriveCount; d++) {
+            cols.deriving = static_cast<PhaseDerivative>(d);
+            auto t2 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) cols.derivePhase(col, &prev);
+            auto t3 = std::chrono::steady_clock::now();
+            us[d] = std::chrono::duration<double, std::micro>(t3 - t2).count() / iterations;
+        }
+        printf("%5d: FFT %.2fus per column, instantaneous frequency %.1f%% of it, group delay %.1f%%, reassign %.1f%%\n",
+               fft_size, us[kDeriveOff], 100.0 * us[kDeriveFrequency] / us[kDeriveOff],
+               100.0 * us[kDeriveDelay] / us[kDeriveOff], 100.0 * us[kDeriveReassign] / us[kDeriveOff]);
+    }
+}
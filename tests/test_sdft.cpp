@@ -0,0 +1,68 @@
+#include <chrono>
+#include <complex>
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+#include "sdft.hpp"
+
+int main(void)
+{
+    // two stationary tones on bins 27 and 64 of a 1024 point window, the tracker reads them
+    // every 16 samples as in the UI
+    const int sampleRate = 48000;
+    const int length = sampleRate * 2;
+    const uint32_t window_size = 1024;
+    const uint32_t decimation = 16;
+    const float tones[2] = { 27.0f * sampleRate / window_size, 64.0f * sampleRate / window_size };
+    std::vector<float> signal(length);
+    for (int j = 0; j < length; j++) {
+        signal[j] = 0.5f * std::sin(2 * M_PI * tones[0] * j / sampleRate + 0.3)
+                  + 0.25f * std::sin(2 * M_PI * tones[1] * j / sampleRate + 1.2);
+    }
+
+    SlidingDFT sdft;
+    sdft.init(sampleRate, window_size, decimation, 64);
+    sdft.setFrequencies(tones, 2);
+    sdft.process(signal.data(), length);
+
+    // the last window read by the tracker, through a periodic Hann and a real FFT
+    std::vector<float> window(window_size);
+    hann(window.data(), window_size, false);
+    std::vector<float> frame(window_size);
+    for (uint32_t i = 0; i < window_size; i++) frame[i] = signal[length - window_size + i] * window[i];
+    std::vector<std::complex<float>> spectrum(window_size / 2 + 1);
+    pocketfft::shape_t shape{window_size};
+    pocketfft::stride_t stride_in{sizeof(float)};
+    pocketfft::stride_t stride_out{sizeof(std::complex<float>)};
+    pocketfft::r2c(shape, stride_in, stride_out, 0, pocketfft::FORWARD, frame.data(), spectrum.data(), 4.0f / window_size);
+
+    const int bins[2] = { 27, 64 };
+    for (int k = 0; k < 2; k++) {
+        const float magnitude = sdft.magnitudeAt(k, sdft.envelope_size - 1);
+        const float phase = sdft.phaseAt(k, sdft.envelope_size - 1);
+        const std::complex<float> v = spectrum[bins[k]];
+        printf("%7.2fHz: sdft %f @ %+f rad, fft bin %d %f @ %+f rad\n",
+               tones[k], magnitude, phase, bins[k], std::abs(v), std::arg(v));
+    }
+
+    // cost of all eight tracks per sample against a fresh FFT every decimation samples
+    const float eight[SlidingDFT::max_tracks] = { 100, 200, 400, 800, 1600, 3200, 6400, 12800 };
+    sdft.setFrequencies(eight, SlidingDFT::max_tracks);
+    auto start = std::chrono::steady_clock::now();
+    sdft.process(signal.data(), length);
+    const double sdft_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / length;
+
+    const int hops = (length - window_size) / decimation;
+    start = std::chrono::steady_clock::now();
+    for (int h = 0; h < hops; h++) {
+        const float * x = &signal[h * decimation];
+        for (uint32_t i = 0; i < window_size; i++) frame[i] = x[i] * window[i];
+        pocketfft::r2c(shape, stride_in, stride_out, 0, pocketfft::FORWARD, frame.data(), spectrum.data(), 1.0f);
+    }
+    const double fft_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (hops * decimation);
+    printf("per sample: sdft %d tracks %.2fns, fft every %u samples %.2fns\n",
+           SlidingDFT::max_tracks, sdft_ns, decimation, fft_ns);
+}
@@ -0,0 +1,43 @@
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+int main(void)
+{
+    // 1kHz tone plus a burst at 5kHz in the first quarter second
+    const int sampleRate = 48000;
+    const int length = sampleRate * 2;
+    std::vector<float> signal(length);
+    for (int j = 0; j < length; j++) {
+        signal[j] = 0.5f * std::sin(2 * M_PI * 1000.0 * j / sampleRate);
+        if (j < sampleRate / 4) signal[j] += 0.25f * std::sin(2 * M_PI * 5000.0 * j / sampleRate);
+    }
+
+    auto window_size = 960;
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(window_size), window_size);
+    cols.averaging = true;
+    cols.traces.setFrames(10);
+    cols.hold_decay_db = 20.0f;
+
+    auto n_columns = cols.feed(signal.data(), length);
+    printf("processed: %d, traced: %u, %fs per column\n", n_columns, cols.traces.count, cols.secondsPerColumn());
+
+    // bins are 50Hz wide, 1kHz is bin 20 and 5kHz bin 100
+    const int bins[] = { 20, 100 };
+    for (int b : bins) {
+        printf("%fHz: last %f exp %f linear %f min %f max %f\n", cols.frequencyAt(b), cols.columns.back().bins[b],
+               cols.traces.exponential[b], cols.traces.linear[b], cols.traces.min_hold[b], cols.traces.max_hold[b]);
+    }
+    // the burst ended 1.75s ago, max hold should have fallen by 35dB
+    printf("5kHz max hold: %.1fdB below the burst\n", 20 * std::log10(0.25f / cols.traces.max_hold[100]));
+
+    cols.traces.reset();
+    cols.feed(signal.data() + length - window_size, window_size);
+    printf("after reset: traced: %u, 5kHz max %f\n", cols.traces.count, cols.traces.max_hold[100]);
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+// y is x through h = 0.5, 0.25 (a gentle lowpass with half a sample of delay), plus
+// uncorrelated noise 20dB under x. H1 should follow h, coherence drops where h is small.
+int main(void)
+{
+    const int sampleRate = 48000;
+    const int length = sampleRate * 20;
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 0.1);
+    std::vector<float> x(length), y(length);
+    std::vector<double> x_d(length), y_d(length);
+    for (int j = 0; j < length; j++) {
+        x_d[j] = 10.0 * noise(rng);
+        y_d[j] = 0.5 * x_d[j] + (j > 0 ? 0.25 * x_d[j - 1] : 0.0) + noise(rng);
+        x[j] = x_d[j];
+        y[j] = y_d[j];
+    }
+
+    const int window_size = 2048;
+    auto measure = [&](auto& cols_x, auto& cols_y, auto* in_x, auto* in_y, TransferFunction& tf) {
+        for (auto* cols : { &cols_x, &cols_y }) {
+            cols->fct = 2.0;
+            cols->sampleRate = sampleRate;
+            cols->keep_spectra = true;
+        }
+        tf.init(window_size / 2 + 1);
+        // fed in blocks like the UI, the spectra are taken after each block
+        for (int j = 0; j + 4800 <= length; j += 4800) {
+            cols_x.feed(in_x + j, 4800);
+            cols_y.feed(in_y + j, 4800);
+            for (size_t at = 0; at < cols_x.spectra.size(); at += tf.size())
+                tf.accumulate(cols_x.spectra.data() + at, cols_y.spectra.data() + at);
+            cols_x.spectra.clear();
+            cols_y.spectra.clear();
+        }
+    };
+
+    Columns<float> cols_x, cols_y;
+    cols_x.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols_y.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    TransferFunction tf;
+    measure(cols_x, cols_y, x.data(), y.data(), tf);
+
+    Columns<double> precise_x, precise_y;
+    precise_x.init(&cached_hann<double>(window_size), window_size, window_size / 2);
+    precise_y.init(&cached_hann<double>(window_size), window_size, window_size / 2);
+    TransferFunction tf_d;
+    measure(precise_x, precise_y, x_d.data(), y_d.data(), tf_d);
+
+    std::vector<double> mag, phase, coh, mag2, phase2, coh2, mag_d, phase_d, coh_d;
+    tf.query(kTransferH1, mag, phase, coh);
+    tf.query(kTransferH2, mag2, phase2, coh2);
+    tf_d.query(kTransferH1, mag_d, phase_d, coh_d);
+    printf("frames: %llu\n", static_cast<unsigned long long>(tf.frames));
+
+    double worst_mag = 0.0, worst_phase = 0.0, worst_coh = 0.0, worst_precision = 0.0;
+    for (size_t k = 1; k < tf.size() - 1; k++) {
+        const double w = 2 * M_PI * k / window_size;
+        const std::complex<double> h = 0.5 + 0.25 * std::polar(1.0, -w);
+        // expected coherence with noise power 1/100 of x through |h|^2
+        const double snr = std::norm(h) * 100.0;
+        const double expected_coh = snr / (snr + 1.0);
+        worst_mag = std::max(worst_mag, std::abs(mag[k] - 20 * std::log10(std::abs(h))));
+        worst_phase = std::max(worst_phase, std::abs(phase[k] - std::arg(h)));
+        worst_coh = std::max(worst_coh, std::abs(coh[k] - expected_coh));
+        worst_precision = std::max(worst_precision, std::abs(mag[k] - mag_d[k]));
+    }
+    printf("H1 vs h: max %.3fdB, %.4frad\n", worst_mag, worst_phase);
+    printf("coherence vs expected: max %.4f\n", worst_coh);
+    printf("float vs double: max %.5fdB\n", worst_precision);
+    for (size_t k : { 64, 512, 960, 1000 }) {
+        printf("bin %4zu: H1 %7.3fdB H2 %7.3fdB phase %7.4f coherence %.4f\n", k, mag[k], mag2[k], phase[k], coh[k]);
+    }
+}
@@ -0,0 +1,62 @@
+#include <cstdio>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+int main(void)
+{
+    // one minute of white noise at -20dBFS rms plus a -40dBFS sine at 3kHz
+    const int sampleRate = 48000;
+    const int length = sampleRate * 60;
+    const double sigma = 0.1 / std::sqrt(2.0);
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, sigma);
+    std::vector<float> signal(length);
+    std::vector<double> signal_d(length);
+    for (int j = 0; j < length; j++) {
+        signal_d[j] = noise(rng) + 0.01 * std::sin(2 * M_PI * 3000.0 * j / sampleRate);
+        signal[j] = signal_d[j];
+    }
+
+    auto window_size = 4096;
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&cached_hann<float>(window_size), window_size, window_size / 2);
+    cols.psd = true;
+    // fed in blocks like the UI, the PSD is queried while frames keep coming
+    for (int j = 0; j < length; j += 4800) cols.feed(signal.data() + j, 4800);
+
+    Columns<double> precise;
+    precise.fct = 2.0;
+    precise.sampleRate = sampleRate;
+    precise.init(&cached_hann<double>(window_size), window_size, window_size / 2);
+    precise.psd = true;
+    precise.feed(signal_d.data(), length);
+
+    std::vector<double> psd, psd_d;
+    cols.welch.query(psd, sampleRate, cols.fct);
+    precise.welch.query(psd_d, sampleRate, precise.fct);
+    printf("frames: %llu (%.3fs), enbw: %f bins\n", static_cast<unsigned long long>(cols.welch.frames),
+           cols.welch.seconds(sampleRate, cols.hop_size), cols.welch.enbw());
+
+    // noise floor averaged away from DC and the tone
+    double mean = 0.0, mean_d = 0.0;
+    int n = 0;
+    for (size_t k = 100; k < psd.size() - 100; k++) {
+        if (std::abs(static_cast<int>(k) - 256) < 16) continue;
+        mean += psd[k];
+        mean_d += psd_d[k];
+        n++;
+    }
+    printf("noise: %fdBFS/Hz (double %f), expected %fdBFS/Hz\n", mean / n, mean_d / n,
+           10 * std::log10(2 * sigma * sigma / sampleRate / 0.5));
+
+    // integrating the density around the tone, minus the noise in that band, gives its power back
+    double power = 0.0;
+    for (int k = 250; k <= 262; k++) power += (std::pow(10.0, psd_d[k] / 10) - std::pow(10.0, mean_d / n / 10)) * sampleRate / window_size;
+    printf("tone: %fdBFS, expected -40dBFS\n", 10 * std::log10(power));
+}
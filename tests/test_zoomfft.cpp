@@ -0,0 +1,45 @@
+#include <cstdio>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.hpp"
+
+int main(void)
+{
+    // two tones 0.5Hz apart, a 512 point full band FFT has 93.75Hz bins
+    const int sampleRate = 48000;
+    const int length = sampleRate * 30;
+    std::vector<float> signal(length);
+    for (int j = 0; j < length; j++) {
+        signal[j] = 0.5f * std::sin(2 * M_PI * 1000.0 * j / sampleRate)
+                  + 0.25f * std::sin(2 * M_PI * 1000.5 * j / sampleRate);
+    }
+
+    auto window_size = 512;
+    std::vector<float> window;
+    window.resize(window_size);
+    hann(window.data(), window_size, false);
+
+    Columns<float> cols;
+    cols.fct = 2.0;
+    cols.sampleRate = sampleRate;
+    cols.init(&window, window_size);
+    cols.setZoom(true, 990.0f, 1010.0f);
+    printf("decimation: %d, decimated rate: %fHz, resolution: %fHz, %zu bins\n",
+           cols.zoom.decimation, cols.zoom.decimatedRate(), cols.zoom.decimatedRate() / window_size, cols.outputSize());
+
+    // feed in host sized blocks
+    int n_columns = 0;
+    for (int j = 0; j + 512 <= length; j += 512) {
+        n_columns += cols.feed(&signal[j], 512);
+    }
+    printf("processed: %d\n", n_columns);
+
+    auto& col = cols.columns.back();
+    printf("peak: %d -> %fHz @ %f\n", col.peakBin, col.peakFrequency, col.peakMagnitude);
+    for (size_t i = 0; i < col.size; i++) {
+        if (col.bins_peak[i] && col.bins[i] > 0.05f)
+            printf("  local peak %zu -> %fHz @ %f\n", i, cols.frequencyAt(i), col.bins[i]);
+    }
+}
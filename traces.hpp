@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+enum TraceMode {
+    kTraceOff = 0,
+    kTraceExponential,
+    kTraceLinear,
+    kTraceMinHold,
+    kTraceMaxHold,
+    kTraceCount
+};
+
+// One pass over the bins updates every trace:
+// exponential average, linear sum, min hold rising by 1 / decay and max hold falling by decay
+void update_traces(const float * x, float * expo, float * sum, float * mn, float * mx, unsigned n, float alpha, float decay)
+{
+    const simde__m256 a = simde_mm256_set1_ps(alpha);
+    const simde__m256 d = simde_mm256_set1_ps(decay);
+    const simde__m256 inv_d = simde_mm256_set1_ps(1.0f / decay);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 v = simde_mm256_loadu_ps(&x[i]);
+        simde__m256 e = simde_mm256_loadu_ps(&expo[i]);
+        simde_mm256_storeu_ps(&expo[i], simde_mm256_add_ps(e, simde_mm256_mul_ps(a, simde_mm256_sub_ps(v, e))));
+        simde_mm256_storeu_ps(&sum[i], simde_mm256_add_ps(simde_mm256_loadu_ps(&sum[i]), v));
+        simde_mm256_storeu_ps(&mn[i], simde_mm256_min_ps(v, simde_mm256_mul_ps(simde_mm256_loadu_ps(&mn[i]), inv_d)));
+        simde_mm256_storeu_ps(&mx[i], simde_mm256_max_ps(v, simde_mm256_mul_ps(simde_mm256_loadu_ps(&mx[i]), d)));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        expo[k] += alpha * (x[k] - expo[k]);
+        sum[k] += x[k];
+        mn[k] = std::min(x[k], mn[k] / decay);
+        mx[k] = std::max(x[k], mx[k] * decay);
+    }
+}
+
+void update_traces(const double * x, double * expo, double * sum, double * mn, double * mx, unsigned n, double alpha, double decay)
+{
+    const simde__m256d a = simde_mm256_set1_pd(alpha);
+    const simde__m256d d = simde_mm256_set1_pd(decay);
+    const simde__m256d inv_d = simde_mm256_set1_pd(1.0 / decay);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d v = simde_mm256_loadu_pd(&x[i]);
+        simde__m256d e = simde_mm256_loadu_pd(&expo[i]);
+        simde_mm256_storeu_pd(&expo[i], simde_mm256_add_pd(e, simde_mm256_mul_pd(a, simde_mm256_sub_pd(v, e))));
+        simde_mm256_storeu_pd(&sum[i], simde_mm256_add_pd(simde_mm256_loadu_pd(&sum[i]), v));
+        simde_mm256_storeu_pd(&mn[i], simde_mm256_min_pd(v, simde_mm256_mul_pd(simde_mm256_loadu_pd(&mn[i]), inv_d)));
+        simde_mm256_storeu_pd(&mx[i], simde_mm256_max_pd(v, simde_mm256_mul_pd(simde_mm256_loadu_pd(&mx[i]), d)));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        expo[k] += alpha * (x[k] - expo[k]);
+        sum[k] += x[k];
+        mn[k] = std::min(x[k], mn[k] / decay);
+        mx[k] = std::max(x[k], mx[k] * decay);
+    }
+}
+
+// Per-bin traces updated incrementally with each column, a few bin-sized arrays each.
+// Linear averages blocks of `frames` columns: the sum restarts once a block is complete and
+// `linear` holds the last complete block, or the running mean before the first one.
+template <typename T>
+struct SpectrumTraces {
+    size_t size = 0;
+    uint32_t frames = 16;
+    uint32_t count = 0;
+    T alpha = 2.0 / 17;
+    T decay = 1.0;
+
+    std::vector<T> exponential;
+    std::vector<T> linear;
+    std::vector<T> sum;
+    std::vector<T> min_hold;
+    std::vector<T> max_hold;
+
+    // alpha gives the exponential average the same equivalent length as the linear one
+    void setFrames(uint32_t _frames)
+    {
+        frames = std::max(1u, _frames);
+        alpha = T(2) / (frames + 1);
+    }
+
+    void reset()
+    {
+        count = 0;
+        size = 0;
+    }
+
+    void update(const T* bins, size_t n)
+    {
+        if (count == 0 || n != size) {
+            // first frame seeds every trace
+            size = n;
+            exponential.assign(bins, bins + n);
+            linear.assign(bins, bins + n);
+            sum.assign(n, T(0));
+            min_hold.assign(bins, bins + n);
+            max_hold.assign(bins, bins + n);
+            count = 0;
+        }
+        update_traces(bins, exponential.data(), sum.data(), min_hold.data(), max_hold.data(), n, alpha, decay);
+        count++;
+
+        const T scale = T(1) / (count % frames == 0 ? frames : count);
+        if (count % frames == 0 || count < frames) {
+            for (size_t i = 0; i < n; i++) linear[i] = sum[i] * scale;
+        }
+        if (count % frames == 0) std::fill(sum.begin(), sum.end(), T(0));
+    }
+
+    const std::vector<T>* trace(TraceMode mode) const
+    {
+        switch (mode) {
+            case kTraceExponential: return &exponential;
+            case kTraceLinear:      return &linear;
+            case kTraceMinHold:     return &min_hold;
+            case kTraceMaxHold:     return &max_hold;
+            default: break;
+        }
+        return nullptr;
+    }
+};
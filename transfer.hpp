@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+enum TransferEstimator {
+    kTransferOff = 0,
+    kTransferH1,
+    kTransferH2,
+    kTransferCount
+};
+
+// Two bins per register: a = x0 x1, b = y0 y1 as (re, im) pairs, returns conj(x) y
+static inline simde__m256d conj_mul_pd(simde__m256d a, simde__m256d b)
+{
+    const simde__m256d conj = simde_mm256_set_pd(-1.0, 1.0, -1.0, 1.0);
+    simde__m256d p = simde_mm256_mul_pd(a, b);
+    simde__m256d q = simde_mm256_mul_pd(simde_mm256_mul_pd(a, simde_mm256_permute_pd(b, 0x5)), conj);
+    // re = xr yr + xi yi, im = xr yi - xi yr
+    return simde_mm256_hadd_pd(p, q);
+}
+
+// gxy += conj(x) y, gxx += |x|^2, gyy += |y|^2, each accumulator scaled by decay first
+static inline void cross_pair(simde__m256d a, simde__m256d b, double * gxy, double * gxx, double * gyy, simde__m256d decay)
+{
+    simde__m256d c = conj_mul_pd(a, b);
+    simde_mm256_storeu_pd(gxy, simde_mm256_add_pd(simde_mm256_mul_pd(simde_mm256_loadu_pd(gxy), decay), c));
+    // |x0|^2 |y0|^2 |x1|^2 |y1|^2 -> |x0|^2 |x1|^2 |y0|^2 |y1|^2
+    simde__m256d s = simde_mm256_hadd_pd(simde_mm256_mul_pd(a, a), simde_mm256_mul_pd(b, b));
+    s = simde_mm256_permute4x64_pd(s, 0xD8);
+    simde__m128d d = simde_mm256_castpd256_pd128(decay);
+    simde_mm_storeu_pd(gxx, simde_mm_add_pd(simde_mm_mul_pd(simde_mm_loadu_pd(gxx), d), simde_mm256_castpd256_pd128(s)));
+    simde_mm_storeu_pd(gyy, simde_mm_add_pd(simde_mm_mul_pd(simde_mm_loadu_pd(gyy), d), simde_mm256_extractf128_pd(s, 1)));
+}
+
+void accumulate_cross(const std::complex<float> * x, const std::complex<float> * y, std::complex<double> * gxy, double * gxx, double * gyy, unsigned n, double decay)
+{
+    const float * fx = reinterpret_cast<const float *>(x);
+    const float * fy = reinterpret_cast<const float *>(y);
+    double * g = reinterpret_cast<double *>(gxy);
+    const simde__m256d d = simde_mm256_set1_pd(decay);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256 a = simde_mm256_loadu_ps(&fx[2 * i]);
+        simde__m256 b = simde_mm256_loadu_ps(&fy[2 * i]);
+        cross_pair(simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(a)), simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(b)),
+                   &g[2 * i], &gxx[i], &gyy[i], d);
+        cross_pair(simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(a, 1)), simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(b, 1)),
+                   &g[2 * i + 4], &gxx[i + 2], &gyy[i + 2], d);
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        const std::complex<double> xk(x[k]), yk(y[k]);
+        gxy[k] = gxy[k] * decay + std::conj(xk) * yk;
+        gxx[k] = gxx[k] * decay + std::norm(xk);
+        gyy[k] = gyy[k] * decay + std::norm(yk);
+    }
+}
+
+void accumulate_cross(const std::complex<double> * x, const std::complex<double> * y, std::complex<double> * gxy, double * gxx, double * gyy, unsigned n, double decay)
+{
+    const double * dx = reinterpret_cast<const double *>(x);
+    const double * dy = reinterpret_cast<const double *>(y);
+    double * g = reinterpret_cast<double *>(gxy);
+    const simde__m256d d = simde_mm256_set1_pd(decay);
+    unsigned i;
+    for (i = 0; i < n - n % 2; i += 2)
+    {
+        cross_pair(simde_mm256_loadu_pd(&dx[2 * i]), simde_mm256_loadu_pd(&dy[2 * i]), &g[2 * i], &gxx[i], &gyy[i], d);
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        gxy[k] = gxy[k] * decay + std::conj(x[k]) * y[k];
+        gxx[k] = gxx[k] * decay + std::norm(x[k]);
+        gyy[k] = gyy[k] * decay + std::norm(y[k]);
+    }
+}
+
+// Dual-channel measurement, x is the reference and y the measured response.
+// Cross and auto spectra are summed per bin in double precision: a plain average over every
+// frame since reset(), or an exponential one over about `frames` frames once setFrames() is used.
+struct TransferFunction {
+    std::vector<std::complex<double>> gxy;
+    std::vector<double> gxx;
+    std::vector<double> gyy;
+    uint64_t frames = 0;
+    double decay = 1.0;
+
+    void init(size_t bins)
+    {
+        gxy.resize(bins);
+        gxx.resize(bins);
+        gyy.resize(bins);
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(gxy.begin(), gxy.end(), std::complex<double>(0.0));
+        std::fill(gxx.begin(), gxx.end(), 0.0);
+        std::fill(gyy.begin(), gyy.end(), 0.0);
+        frames = 0;
+    }
+
+    // 0 averages everything, otherwise same equivalent length as the exponential trace
+    void setFrames(uint32_t n)
+    {
+        decay = n == 0 ? 1.0 : 1.0 - 2.0 / (n + 1);
+    }
+
+    size_t size() const { return gxx.size(); }
+
+    template <typename T>
+    void accumulate(const std::complex<T>* x, const std::complex<T>* y)
+    {
+        accumulate_cross(x, y, gxy.data(), gxx.data(), gyy.data(), size(), decay);
+        frames++;
+    }
+
+    // Magnitude-squared coherence, 0 where either channel is silent
+    double coherence(size_t k) const
+    {
+        const double p = gxx[k] * gyy[k];
+        return p > 0.0 ? std::min(std::norm(gxy[k]) / p, 1.0) : 0.0;
+    }
+
+    // H1 = Gxy / Gxx is biased low by noise on the reference, H2 = Gyy / Gyx by noise on
+    // the measurement. Magnitude in dB, phase in radians, both only defined where coherence isn't 0.
+    std::complex<double> response(TransferEstimator estimator, size_t k) const
+    {
+        if (estimator == kTransferH2)
+            return std::norm(gxy[k]) > 0.0 ? gyy[k] / std::conj(gxy[k]) : std::complex<double>(0.0);
+        return gxx[k] > 0.0 ? gxy[k] / gxx[k] : std::complex<double>(0.0);
+    }
+
+    void query(TransferEstimator estimator, std::vector<double>& magnitude_db, std::vector<double>& phase, std::vector<double>& coh) const
+    {
+        magnitude_db.resize(size());
+        phase.resize(size());
+        coh.resize(size());
+        for (size_t k = 0; k < size(); k++)
+        {
+            const std::complex<double> h = response(estimator, k);
+            magnitude_db[k] = 20.0 * std::log10(std::max(std::abs(h), 1e-20));
+            phase[k] = std::arg(h);
+            coh[k] = coherence(k);
+        }
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "simde/x86/avx2.h"
+
+// acc[i] += |in[i]|^2, squares are summed pairwise with hadd then widened to double
+void accumulate_power(const std::complex<float> * in, double * acc, unsigned n)
+{
+    const float * f = reinterpret_cast<const float *>(in);
+    unsigned i;
+    for (i = 0; i < n - n % 8; i += 8)
+    {
+        simde__m256 a = simde_mm256_loadu_ps(&f[2 * i]);
+        simde__m256 b = simde_mm256_loadu_ps(&f[2 * i + 8]);
+        simde__m256 h = simde_mm256_hadd_ps(simde_mm256_mul_ps(a, a), simde_mm256_mul_ps(b, b));
+        h = simde_mm256_castpd_ps(simde_mm256_permute4x64_pd(simde_mm256_castps_pd(h), 0xD8));
+        simde__m256d lo = simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(h));
+        simde__m256d hi = simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(h, 1));
+        simde_mm256_storeu_pd(&acc[i], simde_mm256_add_pd(simde_mm256_loadu_pd(&acc[i]), lo));
+        simde_mm256_storeu_pd(&acc[i + 4], simde_mm256_add_pd(simde_mm256_loadu_pd(&acc[i + 4]), hi));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        acc[k] += std::norm(std::complex<double>(in[k]));
+    }
+}
+
+void accumulate_power(const std::complex<double> * in, double * acc, unsigned n)
+{
+    const double * d = reinterpret_cast<const double *>(in);
+    unsigned i;
+    for (i = 0; i < n - n % 4; i += 4)
+    {
+        simde__m256d a = simde_mm256_loadu_pd(&d[2 * i]);
+        simde__m256d b = simde_mm256_loadu_pd(&d[2 * i + 4]);
+        simde__m256d h = simde_mm256_hadd_pd(simde_mm256_mul_pd(a, a), simde_mm256_mul_pd(b, b));
+        h = simde_mm256_permute4x64_pd(h, 0xD8);
+        simde_mm256_storeu_pd(&acc[i], simde_mm256_add_pd(simde_mm256_loadu_pd(&acc[i]), h));
+    }
+    // non-vectorisable remaining elements
+    for (unsigned k = i; k < n; k++)
+    {
+        acc[k] += std::norm(in[k]);
+    }
+}
+
+// Welch power spectral density: power of every analysed frame summed per bin in double
+// precision, averaged on query. Overlap is whatever hop the frames come with.
+struct WelchPSD {
+    std::vector<double> sum;
+    uint64_t frames = 0;
+    uint32_t window_size = 0;
+    // window sums, S1 = sum(w), S2 = sum(w^2)
+    double s1 = 0.0;
+    double s2 = 0.0;
+
+    template <typename T>
+    void init(const T* window, uint32_t _window_size)
+    {
+        window_size = _window_size;
+        s1 = 0.0;
+        s2 = 0.0;
+        for (uint32_t i = 0; i < window_size; i++)
+        {
+            s1 += window[i];
+            s2 += static_cast<double>(window[i]) * window[i];
+        }
+        reset();
+    }
+
+    void reset()
+    {
+        sum.assign(window_size / 2 + 1, 0.0);
+        frames = 0;
+    }
+
+    template <typename T>
+    void accumulate(const std::complex<T>* spectrum, size_t n)
+    {
+        accumulate_power(spectrum, sum.data(), n);
+        frames++;
+    }
+
+    // Equivalent noise bandwidth of the window in bins, 1.5 for Hann
+    double enbw() const { return window_size * s2 / (s1 * s1); }
+
+    double seconds(float sampleRate, uint32_t hop_size) const
+    {
+        return frames == 0 ? 0.0 : (static_cast<double>(frames - 1) * hop_size + window_size) / sampleRate;
+    }
+
+    // One-sided PSD in dBFS/Hz, 0dBFS being the power of a full scale sine. scale is the
+    // factor the spectrum was computed with (Columns::fct).
+    void query(std::vector<double>& out, float sampleRate, double scale) const
+    {
+        out.resize(sum.size());
+        if (frames == 0) {
+            std::fill(out.begin(), out.end(), -400.0);
+            return;
+        }
+        // 2 |X|^2 / S1^2 is the power of a sine at its bin, dividing by the ENBW in Hz gives density
+        const double enbw_hz = enbw() * sampleRate / window_size;
+        const double norm = 1.0 / (frames * scale * scale * s1 * s1 * enbw_hz * 0.5);
+        for (size_t k = 0; k < sum.size(); k++)
+        {
+            // DC and Nyquist have no negative frequency twin
+            const bool single = k == 0 || (window_size % 2 == 0 && k == sum.size() - 1);
+            const double p = sum[k] * norm * (single ? 1.0 : 2.0);
+            out[k] = 10.0 * std::log10(std::max(p, 1e-40));
+        }
+    }
+};
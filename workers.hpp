@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running one batch of tasks at a time. Task indices are handed out
+// in order through an atomic counter, fn(task, worker) runs on the pool threads and
+// `finished` counts completed tasks so the caller can poll progress without waiting.
+struct WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::function<void(size_t, size_t)> job;
+    size_t n_tasks = 0;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    size_t running = 0;
+    uint64_t generation = 0;
+    bool quit = false;
+
+    ~WorkerPool()
+    {
+        cancel();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    size_t size() const { return threads.size(); }
+
+    void start(size_t n_threads)
+    {
+        if (!threads.empty()) return;
+        for (size_t w = 0; w < std::max<size_t>(1, n_threads); w++)
+            threads.emplace_back([this, w]() { loop(w); });
+    }
+
+    // Starts a batch and returns right away, a previous batch is cancelled first
+    void submit(size_t tasks, std::function<void(size_t, size_t)> fn)
+    {
+        cancel();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = std::move(fn);
+            n_tasks = tasks;
+            finished.store(0);
+            next.store(0);
+            generation++;
+        }
+        wake.notify_all();
+    }
+
+    bool busy() const { return finished.load(std::memory_order_acquire) < n_tasks; }
+
+    // Returns once every task of the batch is done
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return finished.load() >= n_tasks && running == 0; });
+    }
+
+    // Nobody picks up new tasks, returns once the ones in flight are done
+    void cancel()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        next.store(n_tasks);
+        idle.wait(lock, [this]() { return running == 0; });
+    }
+
+private:
+    void loop(size_t worker)
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [&]() { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+            running++;
+            lock.unlock();
+
+            for (size_t task = next.fetch_add(1); task < n_tasks; task = next.fetch_add(1))
+            {
+                job(task, worker);
+                finished.fetch_add(1, std::memory_order_release);
+            }
+
+            lock.lock();
+            if (--running == 0) idle.notify_all();
+        }
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "pocketfft_cached.hpp"
+#include "SimdUtils.hpp"
+
+// Zoom FFT: mixes the band center down to DC with a complex oscillator, low-pass filters and
+// decimates, then runs a complex FFT on the decimated signal so every bin lands in the band.
+struct ZoomFFT {
+    float sampleRate;
+    double center;
+    float span;
+    uint32_t decimation;
+    uint32_t fft_size;
+    uint32_t hop_size;
+
+    // cropped range of the shifted spectrum that covers the span
+    uint32_t first_bin;
+    uint32_t n_bins;
+
+    static constexpr uint32_t taps_per_phase = 32;
+
+    // low-pass, stored time-reversed so it lines up with the history
+    std::vector<float> taps;
+    std::vector<float> history_re;
+    std::vector<float> history_im;
+    size_t next_output;
+    double osc_phase;
+
+    std::vector<std::complex<float>> frame;
+    std::vector<std::complex<float>> windowed;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<float> window;
+    std::vector<float> bins;
+    std::vector<float> bins_phase;
+
+    pocketfft::shape_t shape{0};
+    pocketfft::stride_t stride{sizeof(std::complex<float>)};
+
+    size_t size() const { return n_bins; }
+
+    float decimatedRate() const { return sampleRate / decimation; }
+
+    float frequencyAt(size_t bin) const
+    {
+        return center + (static_cast<float>(first_bin + bin) - fft_size / 2) * decimatedRate() / fft_size;
+    }
+
+    void init(float _sampleRate, float lo, float hi, uint32_t _fft_size)
+    {
+        sampleRate = _sampleRate;
+        center = (lo + hi) / 2;
+        span = std::max(hi - lo, 1.0f);
+        fft_size = _fft_size;
+        hop_size = fft_size / 4;
+
+        // complex output only needs fs / D > span, keep a margin for the filter transition
+        decimation = std::max(1, static_cast<int>(sampleRate / (1.5f * span)));
+
+        // Blackman windowed sinc, -6dB at 0.45 of the decimated rate
+        const size_t n_taps = taps_per_phase * decimation;
+        const double cutoff = 0.45 / decimation;
+        taps.resize(n_taps);
+        double sum = 0.0;
+        for (size_t k = 0; k < n_taps; k++)
+        {
+            double x = k - (n_taps - 1) / 2.0;
+            double sinc = x == 0.0 ? 2 * cutoff : std::sin(2 * M_PI * cutoff * x) / (M_PI * x);
+            double w = 0.42 - 0.5 * std::cos(2 * M_PI * k / (n_taps - 1)) + 0.08 * std::cos(4 * M_PI * k / (n_taps - 1));
+            taps[n_taps - 1 - k] = sinc * w;
+            sum += sinc * w;
+        }
+        for (auto& t : taps) t /= sum;
+
+        history_re.clear();
+        history_im.clear();
+        next_output = n_taps;
+        osc_phase = 0.0;
+
+        frame.clear();
+        frame.reserve(fft_size);
+        windowed.resize(fft_size);
+        spectrum.resize(fft_size);
+        window.resize(fft_size);
+        for (uint32_t k = 0; k < fft_size; k++)
+        {
+            window[k] = 0.5 - 0.5 * std::cos(2 * M_PI * k / fft_size);
+        }
+        shape[0] = fft_size;
+
+        const uint32_t half = std::min(fft_size / 2 - 1, static_cast<uint32_t>(span / 2 / (decimatedRate() / fft_size)));
+        first_bin = fft_size / 2 - half;
+        n_bins = 2 * half + 1;
+        bins.resize(n_bins);
+        bins_phase.resize(n_bins);
+    }
+
+    // Multiply by e^(-j w n), 8 phasors at a time rotated by e^(-j 8w) and re-anchored
+    // every 1024 samples so float rounding doesn't accumulate
+    void mix(const float* data, size_t length)
+    {
+        const size_t base = history_re.size();
+        history_re.resize(base + length);
+        history_im.resize(base + length);
+        float* re = &history_re[base];
+        float* im = &history_im[base];
+
+        const double w = 2 * M_PI * center / sampleRate;
+        const simde__m256 rot_re = simde_mm256_set1_ps(std::cos(8 * w));
+        const simde__m256 rot_im = simde_mm256_set1_ps(-std::sin(8 * w));
+        simde__m256 p_re = simde_mm256_setzero_ps();
+        simde__m256 p_im = simde_mm256_setzero_ps();
+        size_t i;
+        for (i = 0; i < length - length % 8; i += 8)
+        {
+            if (i % 1024 == 0) {
+                float lanes_re[8], lanes_im[8];
+                for (int l = 0; l < 8; l++)
+                {
+                    double phase = osc_phase + (i + l) * w;
+                    lanes_re[l] = std::cos(phase);
+                    lanes_im[l] = -std::sin(phase);
+                }
+                p_re = simde_mm256_loadu_ps(lanes_re);
+                p_im = simde_mm256_loadu_ps(lanes_im);
+            }
+            simde__m256 x = simde_mm256_loadu_ps(&data[i]);
+            simde_mm256_storeu_ps(&re[i], simde_mm256_mul_ps(x, p_re));
+            simde_mm256_storeu_ps(&im[i], simde_mm256_mul_ps(x, p_im));
+            simde__m256 n_re = simde_mm256_sub_ps(simde_mm256_mul_ps(p_re, rot_re), simde_mm256_mul_ps(p_im, rot_im));
+            simde__m256 n_im = simde_mm256_add_ps(simde_mm256_mul_ps(p_re, rot_im), simde_mm256_mul_ps(p_im, rot_re));
+            p_re = n_re;
+            p_im = n_im;
+        }
+        // non-vectorisable remaining elements
+        for (size_t k = i; k < length; k++)
+        {
+            double phase = osc_phase + k * w;
+            re[k] = data[k] * std::cos(phase);
+            im[k] = -data[k] * std::sin(phase);
+        }
+        osc_phase = std::fmod(osc_phase + length * w, 2 * M_PI);
+    }
+
+    void transform()
+    {
+        for (uint32_t k = 0; k < fft_size; k++)
+        {
+            windowed[k] = frame[k] * window[k];
+        }
+        pocketfft::c2c(shape, stride, stride, {0}, pocketfft::FORWARD, windowed.data(), spectrum.data(), 4.0f / fft_size);
+
+        // negative frequencies first, spectrum[0] is the band center
+        for (uint32_t b = 0; b < n_bins; b++)
+        {
+            const auto& v = spectrum[(first_bin + b + fft_size / 2) % fft_size];
+            bins[b] = std::abs(v);
+            bins_phase[b] = std::arg(v);
+        }
+    }
+
+    // Calls emit() after each new zoomed frame, bins/bins_phase hold the result
+    template <typename F>
+    int process(const float* data, size_t length, F&& emit)
+    {
+        mix(data, length);
+
+        int fed = 0;
+        const size_t n_taps = taps.size();
+        while (next_output <= history_re.size())
+        {
+            const size_t start = next_output - n_taps;
+            frame.emplace_back(simd_buffer_dot(taps.data(), &history_re[start], n_taps),
+                               simd_buffer_dot(taps.data(), &history_im[start], n_taps));
+            next_output += decimation;
+
+            if (frame.size() == fft_size) {
+                transform();
+                emit();
+                frame.erase(frame.begin(), frame.begin() + hop_size);
+                fed++;
+            }
+        }
+
+        // keep only the history the next output still needs
+        const size_t drop = std::min(next_output - n_taps, history_re.size());
+        history_re.erase(history_re.begin(), history_re.begin() + drop);
+        history_im.erase(history_im.begin(), history_im.begin() + drop);
+        next_output -= drop;
+        return fed;
+    }
+};